@@ -0,0 +1,58 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "benchmark_utils.h"
+#include "flat_ast.h"
+#include "parser.h"
+
+// every heap allocation of the process goes through here
+namespace {
+    std::atomic<std::size_t> allocations = 0;
+}
+
+void *operator new(const std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (const auto memory = std::malloc(size == 0 ? 1 : size); memory != nullptr) {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+// Heap allocations made while parsing source, per node of the resulting tree. Arena chunks are counted too, a
+// handful of them per parse.
+void reportAllocations(const std::string &name, const std::string &source, const ParserOptions options = {}) {
+    const auto before = allocations.load();
+    Parser parser{Lexer{std::string_view{source}}, options};
+    const std::unique_ptr<Program> program{parser.parseProgram()};
+    const auto made = allocations.load() - before;
+    const auto nodes = FlatAst::from(*program).nodes.size();
+    std::cout << name << ": " << made << " allocations for " << nodes << " nodes, "
+            << static_cast<double>(made) / static_cast<double>(nodes) << " per node" << std::endl;
+}
+
+int main() {
+    const auto source = BenchmarkUtils::generateSource(4 * 1024 * 1024);
+    reportAllocations("Parser", source);
+    reportAllocations("Parser, hash-consing", source, ParserOptions{.hashConsing = true});
+
+    constexpr int iterations = 5;
+    const auto seconds = BenchmarkUtils::measure(iterations, [&] {
+        Parser parser{Lexer{std::string_view{source}}};
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+    });
+    BenchmarkUtils::report("Parser", static_cast<double>(source.size() * iterations), "bytes", seconds);
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "benchmark_utils.h"
+#include "ast_image.h"
+#include "constant_folding.h"
+#include "flat_ast.h"
+#include "mapped_file.h"
+#include "parser.h"
+
+int main() {
+    const auto source = BenchmarkUtils::generateSource(4 * 1024 * 1024);
+    Parser parser{Lexer{source}};
+    const std::unique_ptr<Program> program{parser.parseProgram()};
+    const auto flat = FlatAst::from(*program);
+    const auto nodes = static_cast<double>(flat.nodes.size());
+
+    std::cout << "nodes: " << flat.nodes.size() << std::endl;
+    std::cout << "Program bytes/node: " << static_cast<double>(program->arena->bytesAllocated()) / nodes << std::endl;
+    std::cout << "FlatAst bytes/node: " << static_cast<double>(flat.bytes()) / nodes << std::endl;
+
+    constexpr int iterations = 5;
+    std::size_t printed = 0;
+    const auto treeSeconds = BenchmarkUtils::measure(iterations, [&] { printed += program->to_string().size(); });
+    BenchmarkUtils::report("Program::to_string", nodes * iterations, "nodes", treeSeconds);
+    const auto flatSeconds = BenchmarkUtils::measure(iterations, [&] { printed += flat.to_string().size(); });
+    BenchmarkUtils::report("FlatAst::to_string", nodes * iterations, "nodes", flatSeconds);
+
+    std::size_t integers = 0;
+    const auto scanSeconds = BenchmarkUtils::measure(iterations, [&] {
+        for (const auto &node: flat.nodes) {
+            integers += node.kind == NodeKind::INTEGER_LITERAL;
+        }
+    });
+    BenchmarkUtils::report("FlatAst linear scan", nodes * iterations, "nodes", scanSeconds);
+
+    std::size_t eliminated = 0;
+    const auto foldSeconds = BenchmarkUtils::measure(iterations, [&] {
+        eliminated = foldConstants(*program).eliminated;
+    });
+    BenchmarkUtils::report("foldConstants", nodes * iterations, "nodes", foldSeconds);
+    std::cout << "foldConstants eliminated " << eliminated << " nodes" << std::endl;
+
+    // startup with and without a cached image of the source
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto sourcePath = (directory / "pitaya_benchmark.monkey").string();
+    const auto imagePath = sourcePath + ".ast";
+    // only a file that parses cleanly gets an image, and "!-/*5;" doesn't
+    auto clean = source;
+    for (auto at = clean.find("/*"); at != std::string::npos; at = clean.find("/*", at)) {
+        clean.replace(at, 2, "  ");
+    }
+    std::ofstream{sourcePath, std::ios::binary | std::ios::trunc} << clean;
+    std::filesystem::remove(imagePath);
+    const auto bytes = static_cast<double>(source.size());
+    const auto parseSeconds = BenchmarkUtils::measure(iterations, [&] {
+        Parser fileParser{lexFile(sourcePath)};
+        const std::unique_ptr<Program> parsed{fileParser.parseProgram()};
+    });
+    BenchmarkUtils::report("parse file", bytes * iterations, "bytes", parseSeconds);
+    parseFileCached(sourcePath, imagePath);
+    std::cout << "image bytes: " << std::filesystem::file_size(imagePath) << std::endl;
+    const auto cachedSeconds = BenchmarkUtils::measure(iterations, [&] {
+        printed += parseFileCached(sourcePath, imagePath).program->statements.size();
+    });
+    BenchmarkUtils::report("parseFileCached from image", bytes * iterations, "bytes", cachedSeconds);
+    std::filesystem::remove(sourcePath);
+    std::filesystem::remove(imagePath);
+    return printed + integers == 0;
+}
@@ -0,0 +1,37 @@
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batch.h"
+#include "benchmark_utils.h"
+
+int main() {
+    // a directory of small scripts, like the ones loaded at startup
+    constexpr std::size_t files = 2000;
+    const auto directory = std::filesystem::temp_directory_path() / "pitaya_batch_benchmark";
+    std::filesystem::create_directories(directory);
+    std::vector<std::string> paths;
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < files; i++) {
+        const auto source = BenchmarkUtils::generateSource(8 * 1024 + i % 7 * 1024);
+        paths.push_back((directory / ("script" + std::to_string(i) + ".monkey")).string());
+        std::ofstream{paths.back()} << source;
+        bytes += source.size();
+    }
+
+    const auto cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "hardware threads: " << cores << std::endl;
+    constexpr int iterations = 3;
+    for (std::size_t threads = 1; threads <= std::max(4u, cores); threads *= 2) {
+        const auto seconds = BenchmarkUtils::measure(iterations, [&] { parseFiles(paths, threads); });
+        BenchmarkUtils::report("parseFiles x" + std::to_string(threads), static_cast<double>(bytes * iterations),
+                               "bytes", seconds);
+    }
+    std::filesystem::remove_all(directory);
+    return 0;
+}
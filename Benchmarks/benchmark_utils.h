@@ -0,0 +1,57 @@
+#ifndef PITAYA_BENCHMARK_UTILS_H
+#define PITAYA_BENCHMARK_UTILS_H
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace BenchmarkUtils {
+    // Builds a Monkey program of roughly `bytes` bytes mixing every token kind the lexer knows about.
+    inline std::string generateSource(const std::size_t bytes) {
+        const std::string snippet = "let five_value = 5;\n"
+                "let ten = 10;\n"
+                "let add = fn(x, y) {\n"
+                "\tx + y;\n"
+                "};\n"
+                "let result = add(five_value, ten);\n"
+                "!-/*5;\n"
+                "5 < 10 > 5;\n"
+                "if (5 < 10) {\n"
+                "\treturn true;\n"
+                "} else {\n"
+                "\treturn false;\n"
+                "}\n"
+                "10 == 10;\n"
+                "10 != 9;\n"
+                "\"foobar\";\n"
+                "\"foo bar\";\n"
+                "[1, 2 * 3, 4 + 5][1];\n"
+                "{\"foo\": \"bar\", \"one\": 1};\n";
+        std::string source;
+        source.reserve(bytes + snippet.size());
+        while (source.size() < bytes) {
+            source += snippet;
+        }
+        return source;
+    }
+
+    // Runs fn `iterations` times and returns the elapsed wall-clock seconds.
+    template<typename Fn>
+    double measure(const int iterations, Fn fn) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            fn();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    inline void report(const std::string &name, const double units, const std::string &unit, const double seconds) {
+        std::cout << std::left << std::setw(32) << name << std::right << std::setw(14) << std::fixed
+                << std::setprecision(0) << units / seconds << " " << unit << "/s" << std::endl;
+    }
+}
+
+#endif //PITAYA_BENCHMARK_UTILS_H
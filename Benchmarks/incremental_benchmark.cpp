@@ -0,0 +1,36 @@
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "benchmark_utils.h"
+#include "incremental.h"
+
+int main() {
+    const auto source = BenchmarkUtils::generateSource(4 * 1024 * 1024);
+
+    constexpr int iterations = 5;
+    const auto fullSeconds = BenchmarkUtils::measure(iterations, [&] {
+        auto parser = Parser{Lexer{source}};
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+    });
+    BenchmarkUtils::report("full parse", iterations, "parses", fullSeconds);
+
+    // typing one character at a time in the middle of the file, then deleting it again
+    IncrementalParser incremental{source};
+    constexpr int keystrokes = 2000;
+    const auto middle = incremental.text().find("let result", source.size() / 2) + 4;
+    std::size_t reparsed = 0;
+    const auto editSeconds = BenchmarkUtils::measure(keystrokes, [&, i = 0]() mutable {
+        if (i++ % 2 == 0) {
+            incremental.edit(TextEdit{middle, 0, "x"});
+        } else {
+            incremental.edit(TextEdit{middle, 1, ""});
+        }
+        reparsed += incremental.reparsed();
+    });
+    BenchmarkUtils::report("IncrementalParser::edit", keystrokes, "edits", editSeconds);
+    std::cout << "statements reparsed per edit: " << static_cast<double>(reparsed) / keystrokes << " of "
+            << incremental.program()->statements.size() << std::endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "lexer.h"
+#include "scanner.h"
+#include "token_buffer.h"
+
+void benchmarkLexer(const std::string &name, const std::string &source) {
+    constexpr int iterations = 10;
+    std::size_t tokens = 0;
+    const auto seconds = BenchmarkUtils::measure(iterations, [&] {
+        Lexer lexer{source};
+        while (lexer.nextToken().tokenType != TokenType::EOF_) {
+            tokens++;
+        }
+    });
+    BenchmarkUtils::report(name, static_cast<double>(tokens), "tokens", seconds);
+    BenchmarkUtils::report(name, static_cast<double>(source.size() * iterations), "bytes", seconds);
+}
+
+// Generated data files: long names, long strings and deep indentation
+std::string generateWideSource(const std::size_t bytes) {
+    const std::string snippet = "                let generated_configuration_entry_name = {\n"
+            "                    \"description\": \"a fairly long generated string literal value\",\n"
+            "                    \"values\": [1234567890, 9876543210, 1122334455]\n"
+            "                };\n";
+    std::string source;
+    while (source.size() < bytes) {
+        source += snippet;
+    }
+    return source;
+}
+
+// Data files are mostly array and hash literals, the shape lexParallel is meant for
+void benchmarkParallelLexer(const std::string &source) {
+    constexpr int iterations = 5;
+    const auto cores = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t threads = 1; threads <= std::max(4u, cores); threads *= 2) {
+        std::size_t tokens = 0;
+        const Lexer lexer{std::string_view{source}};
+        const auto seconds = BenchmarkUtils::measure(iterations, [&] {
+            tokens += TokenBuffer::lexParallel(lexer, threads).size();
+        });
+        BenchmarkUtils::report("lexParallel x" + std::to_string(threads), static_cast<double>(tokens), "tokens",
+                               seconds);
+    }
+}
+
+void benchmarkLookupIdent() {
+    const std::string_view words[] = {
+        "let", "five_value", "fn", "x", "y", "add", "result", "if", "return", "true", "else", "false", "ten", "foo",
+        "lettuce", "fnord", "iffy", "elsewhere", "map", "reduce", "ok", "value", "returns", "falsey",
+    };
+    // shuffled so the branch predictor can't learn the sequence
+    std::vector<std::string_view> sequence;
+    std::mt19937 random{42};
+    std::uniform_int_distribution<std::size_t> pick{0, std::size(words) - 1};
+    for (int i = 0; i < 4096; i++) {
+        sequence.push_back(words[pick(random)]);
+    }
+    constexpr int iterations = 20000000;
+    std::size_t keywords = 0;
+    const auto seconds = BenchmarkUtils::measure(iterations, [&, i = std::size_t{0}]() mutable {
+        keywords += lookupIdent(sequence[i++ % sequence.size()]) != TokenType::IDENT;
+    });
+    BenchmarkUtils::report("lookupIdent", iterations, "lookups", seconds);
+    if (keywords == 0) {
+        std::cout << "no keywords found" << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "scanner: " << Scanner::to_string(Scanner::kernels().level) << std::endl;
+    benchmarkLexer("Lexer::nextToken", BenchmarkUtils::generateSource(4 * 1024 * 1024));
+    benchmarkLexer("Lexer::nextToken (wide)", generateWideSource(4 * 1024 * 1024));
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    benchmarkParallelLexer(generateWideSource(32 * 1024 * 1024));
+    benchmarkLookupIdent();
+    return 0;
+}
@@ -0,0 +1,32 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "parse_cache.h"
+
+int main() {
+    // a handful of snippets sent over and over
+    std::vector<std::string> snippets;
+    for (int i = 0; i < 16; i++) {
+        snippets.push_back(BenchmarkUtils::generateSource(static_cast<std::size_t>(512 + i * 256)) + std::to_string(i));
+    }
+
+    constexpr int iterations = 20000;
+    const auto parseSeconds = BenchmarkUtils::measure(iterations, [&, i = 0]() mutable {
+        Parser parser{Lexer{snippets[static_cast<std::size_t>(i++) % snippets.size()]}};
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+    });
+    BenchmarkUtils::report("parseProgram", iterations, "parses", parseSeconds);
+
+    ParseCache cache{16 * 1024 * 1024};
+    const auto cachedSeconds = BenchmarkUtils::measure(iterations, [&, i = 0]() mutable {
+        cache.parse(snippets[static_cast<std::size_t>(i++) % snippets.size()]);
+    });
+    BenchmarkUtils::report("ParseCache::parse", iterations, "parses", cachedSeconds);
+    const auto stats = cache.stats();
+    std::cout << "hits: " << stats.hits << ", misses: " << stats.misses << ", evictions: " << stats.evictions
+            << ", bytes: " << stats.bytes << std::endl;
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "benchmark_utils.h"
+#include "parser.h"
+#include "parser_session.h"
+#include "token_buffer.h"
+
+// Parses a copy of source per iteration and reports the rate as source bytes
+template<typename MakeParser>
+void benchmarkParse(const std::string &name, const std::string &source, MakeParser makeParser) {
+    constexpr int iterations = 5;
+    std::size_t statements = 0;
+    const auto seconds = BenchmarkUtils::measure(iterations, [&] {
+        auto parser = makeParser();
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+        statements += program->statements.size();
+    });
+    BenchmarkUtils::report(name, static_cast<double>(source.size() * iterations), "bytes", seconds);
+    if (statements == 0) {
+        std::cout << "nothing parsed" << std::endl;
+    }
+}
+
+// Operator soup: long infix chains with prefix, call and index operators, so time goes into parseExpression
+std::string generateExpressionSource(const std::size_t bytes) {
+    const std::string snippet = "a + b * c - d / e < f * -g + h(i, j * 2)[k] - !l == m + n * (o - p) / q[r + 1];\n"
+            "1 + 2 * 3 - 4 / 5 * 6 + 7 - 8 * 9 + -10 < 11 * (12 + 13) != 14 - 15 * 16 / 17 + f(18)[19];\n";
+    std::string source;
+    source.reserve(bytes + snippet.size());
+    while (source.size() < bytes) {
+        source += snippet;
+    }
+    return source;
+}
+
+// A library of functions that are defined but mostly never called, the case lazy function bodies are for
+std::string generateLibrarySource(const std::size_t bytes) {
+    const std::string snippet = "let helper = fn(list, f, initial) {\n"
+            "\tlet iter = fn(arr, result) {\n"
+            "\t\tif (len(arr) == 0) { result } else { iter(rest(arr), f(result, first(arr))) }\n"
+            "\t};\n"
+            "\tlet total = iter(list, initial) * 2 + {\"key\": \"}\"}[\"key\"];\n"
+            "\treturn [total, -total, f(total, 1)][0];\n"
+            "};\n"
+            "helper([1, 2, 3], fn(a, b) { a + b }, 0);\n";
+    std::string source;
+    source.reserve(bytes + snippet.size());
+    while (source.size() < bytes) {
+        source += snippet;
+    }
+    return source;
+}
+
+void reportArena(const std::string &name, Parser parser) {
+    const std::unique_ptr<Program> program{parser.parseProgram()};
+    std::cout << name << ": " << program->arena->bytesAllocated() << " arena bytes" << std::endl;
+}
+
+int main() {
+    const auto source = BenchmarkUtils::generateSource(4 * 1024 * 1024);
+
+    // lexer and parser loops measured on their own, then together
+    constexpr int iterations = 5;
+    std::size_t tokens = 0;
+    const auto lexSeconds = BenchmarkUtils::measure(iterations, [&] {
+        tokens += TokenBuffer::lex(Lexer{source}).size();
+    });
+    BenchmarkUtils::report("TokenBuffer::lex", static_cast<double>(tokens), "tokens", lexSeconds);
+    const auto buffer = TokenBuffer::lex(Lexer{source});
+    benchmarkParse("Parser over TokenBuffer", source, [&] { return Parser{buffer}; });
+
+    benchmarkParse("Parser over Lexer", source, [&] { return Parser{Lexer{source}}; });
+    benchmarkParse("Parser preLex", source, [&] { return Parser{Lexer{source}, ParserOptions{.preLex = true}}; });
+    // lexer on its own thread: only pays off with a second core to run it on
+    benchmarkParse("Parser pipelined", source, [&] {
+        return Parser{Lexer{source}, ParserOptions{.pipelined = true}};
+    });
+
+    const auto expressions = generateExpressionSource(4 * 1024 * 1024);
+    const auto expressionBuffer = TokenBuffer::lex(Lexer{expressions});
+    benchmarkParse("Parser expressions", expressions, [&] { return Parser{expressionBuffer}; });
+
+    const auto library = generateLibrarySource(4 * 1024 * 1024);
+    benchmarkParse("Parser library", library, [&] { return Parser{Lexer{library}}; });
+    benchmarkParse("Parser library, lazy bodies", library, [&] {
+        return Parser{Lexer{library}, ParserOptions{.lazyFunctionBodies = true}};
+    });
+    reportArena("Parser library", Parser{Lexer{library}});
+    reportArena("Parser library, lazy bodies", Parser{Lexer{library}, ParserOptions{.lazyFunctionBodies = true}});
+
+    // a service parsing one small request after another
+    const auto request = BenchmarkUtils::generateSource(2 * 1024);
+    constexpr int requests = 20000;
+    const auto freshSeconds = BenchmarkUtils::measure(requests, [&] {
+        Parser parser{Lexer{request}};
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+    });
+    BenchmarkUtils::report("Parser per request", static_cast<double>(request.size() * requests), "bytes",
+                           freshSeconds);
+    ParserSession session;
+    const auto sessionSeconds = BenchmarkUtils::measure(requests, [&] { session.parse(request); });
+    BenchmarkUtils::report("ParserSession", static_cast<double>(request.size() * requests), "bytes", sessionSeconds);
+    std::cout << "ParserSession: " << session.bytesReserved() << " bytes kept, " << session.recycled()
+            << " parses recycled" << std::endl;
+    return 0;
+}
@@ -0,0 +1,88 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <memory>
+
+#include "arena.h"
+#include "parser.h"
+
+struct Tracked {
+    explicit Tracked(int *destroyed) : destroyed{destroyed} {
+    }
+
+    ~Tracked() {
+        (*destroyed)++;
+    }
+
+    int *destroyed;
+};
+
+BOOST_AUTO_TEST_SUITE(Arena_suite)
+    BOOST_AUTO_TEST_CASE(testAllocationsAreAligned) {
+        ParseArena arena{128};
+        for (int i = 0; i < 100; i++) {
+            arena.allocate(3, 1);
+            const auto p = arena.allocate(sizeof(long), alignof(long));
+            BOOST_REQUIRE_EQUAL(0, reinterpret_cast<std::uintptr_t>(p) % alignof(long));
+        }
+        const auto big = arena.allocate(1024, 16);
+        BOOST_REQUIRE_EQUAL(0, reinterpret_cast<std::uintptr_t>(big) % 16);
+        BOOST_REQUIRE(arena.bytesReserved() >= arena.bytesAllocated());
+    }
+
+    BOOST_AUTO_TEST_CASE(testDestructorsRunWhenArenaIsDropped) {
+        int destroyed = 0;
+        {
+            ParseArena arena{64};
+            for (int i = 0; i < 50; i++) {
+                arena.make<Tracked>(&destroyed);
+            }
+            BOOST_REQUIRE_EQUAL(0, destroyed);
+        }
+        BOOST_REQUIRE_EQUAL(50, destroyed);
+    }
+
+    BOOST_AUTO_TEST_CASE(testProgramOwnsParseArena) {
+        std::weak_ptr<ParseArena> arena;
+        {
+            Parser parser{Lexer{"let add = fn(x, y) { x + y; }; add(1, 2 * 3);"}};
+            const std::unique_ptr<Program> program{parser.parseProgram()};
+            arena = program->arena;
+            BOOST_REQUIRE(arena.lock()->bytesAllocated() > 0);
+            BOOST_REQUIRE_EQUAL(2, program->statements.size());
+        }
+        BOOST_REQUIRE(arena.expired());
+    }
+
+    BOOST_AUTO_TEST_CASE(testResetReusesChunks) {
+        int destroyed = 0;
+        ParseArena arena{256};
+        const auto first = arena.allocate(8, 8);
+        for (int i = 0; i < 100; i++) {
+            arena.make<Tracked>(&destroyed);
+        }
+        const auto reserved = arena.bytesReserved();
+        arena.reset();
+        BOOST_REQUIRE_EQUAL(100, destroyed);
+        BOOST_REQUIRE_EQUAL(0, arena.bytesAllocated());
+        BOOST_REQUIRE_EQUAL(reserved, arena.bytesReserved());
+
+        // the same allocations fit in the chunks already there
+        BOOST_REQUIRE_EQUAL(first, arena.allocate(8, 8));
+        for (int i = 0; i < 100; i++) {
+            arena.make<Tracked>(&destroyed);
+        }
+        BOOST_REQUIRE_EQUAL(reserved, arena.bytesReserved());
+        // one larger than any chunk gets a chunk of its own
+        arena.allocate(4096, 8);
+        BOOST_REQUIRE_EQUAL(reserved + 4096 + 8, arena.bytesReserved());
+
+        arena.reset(512);
+        BOOST_REQUIRE_EQUAL(200, destroyed);
+        BOOST_REQUIRE_EQUAL(512, arena.bytesReserved());
+        arena.reset(0);
+        BOOST_REQUIRE_EQUAL(0, arena.bytesReserved());
+        BOOST_REQUIRE(arena.allocate(8, 8) != nullptr);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ast_image.h"
+
+namespace {
+    std::string tempPath(const std::string &name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    void writeFile(const std::string &path, const std::string &content) {
+        std::ofstream{path, std::ios::binary | std::ios::trunc} << content;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(AstImage_suite)
+    BOOST_AUTO_TEST_CASE(testImageIsWrittenAndReused) {
+        const auto path = tempPath("pitaya_image.monkey");
+        const auto imagePath = path + ".ast";
+        std::filesystem::remove(imagePath);
+        writeFile(path, "let add = fn(a, b) { a + b }; add(\"x\", 2);");
+
+        const auto parsed = parseFileCached(path, imagePath);
+        BOOST_REQUIRE(parsed.errors.empty());
+        BOOST_REQUIRE(std::filesystem::exists(imagePath));
+        // a parsed Program keeps the mapping alive, an inflated one needs nothing from the source
+        BOOST_REQUIRE(parsed.program->source != nullptr);
+
+        const auto cached = parseFileCached(path, imagePath);
+        BOOST_REQUIRE(cached.errors.empty());
+        BOOST_REQUIRE(cached.program->source == nullptr);
+        BOOST_REQUIRE_EQUAL(parsed.program->to_string(), cached.program->to_string());
+
+        // an edit makes the image stale, so the file is parsed again and the image replaced
+        writeFile(path, "let add = fn(a, b) { a - b }; add(\"x\", 2);");
+        const auto edited = parseFileCached(path, imagePath);
+        BOOST_REQUIRE(edited.program->source != nullptr);
+        BOOST_REQUIRE_EQUAL("let add = fn(a, b) (a - b);add(x, 2)", edited.program->to_string());
+        BOOST_REQUIRE(parseFileCached(path, imagePath).program->source == nullptr);
+
+        std::filesystem::remove(path);
+        std::filesystem::remove(imagePath);
+    }
+
+    BOOST_AUTO_TEST_CASE(testBrokenOrErroneousFiles) {
+        const auto path = tempPath("pitaya_image_errors.monkey");
+        const auto imagePath = path + ".ast";
+        std::filesystem::remove(imagePath);
+
+        // a garbage image is ignored and overwritten
+        writeFile(path, "let x = 1; x");
+        writeFile(imagePath, "not an image");
+        const auto parsed = parseFileCached(path, imagePath);
+        BOOST_REQUIRE(parsed.errors.empty());
+        BOOST_REQUIRE_EQUAL("let x = 1;x", parsed.program->to_string());
+        BOOST_REQUIRE(parseFileCached(path, imagePath).program->source == nullptr);
+
+        // a file with errors reports them every time and never gets an image
+        std::filesystem::remove(imagePath);
+        writeFile(path, "let = 1;");
+        BOOST_REQUIRE(!parseFileCached(path, imagePath).errors.empty());
+        BOOST_REQUIRE(!std::filesystem::exists(imagePath));
+
+        const auto missing = parseFileCached(tempPath("pitaya_image_missing.monkey"), imagePath);
+        BOOST_REQUIRE(missing.program == nullptr);
+        BOOST_REQUIRE_EQUAL(1, missing.errors.size());
+
+        std::filesystem::remove(path);
+    }
+
+    BOOST_AUTO_TEST_CASE(testWritersOfTheSameImage) {
+        const auto directory = std::filesystem::temp_directory_path() / "pitaya_image_writers";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directory(directory);
+        const auto path = (directory / "source.monkey").string();
+        const auto imagePath = path + ".ast";
+        writeFile(path, "let x = [1, 2, 3]; x[1]");
+
+        // every thread misses and writes the image, none of them may see another's half-written one
+        std::vector<std::thread> threads;
+        std::vector<std::string> printed(8);
+        for (std::size_t t = 0; t < printed.size(); t++) {
+            threads.emplace_back([&, t] { printed[t] = parseFileCached(path, imagePath).program->to_string(); });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        for (const auto &program: printed) {
+            BOOST_REQUIRE_EQUAL("let x = [1, 2, 3];(x[1])", program);
+        }
+        BOOST_REQUIRE(parseFileCached(path, imagePath).program->source == nullptr);
+        // only the source and the image are left
+        BOOST_REQUIRE_EQUAL(2, std::distance(std::filesystem::directory_iterator{directory},
+                                             std::filesystem::directory_iterator{}));
+
+        std::filesystem::remove_all(directory);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,74 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+
+namespace {
+    struct TempDirectory {
+        std::filesystem::path path;
+
+        TempDirectory() : path{std::filesystem::temp_directory_path() / "pitaya_batch_tests"} {
+            std::filesystem::remove_all(path);
+            std::filesystem::create_directories(path);
+        }
+
+        ~TempDirectory() {
+            std::filesystem::remove_all(path);
+        }
+
+        std::string write(const std::string &name, const std::string &content) const {
+            const auto file = path / name;
+            std::ofstream{file} << content;
+            return file.string();
+        }
+    };
+}
+
+BOOST_AUTO_TEST_SUITE(Batch_suite)
+    BOOST_AUTO_TEST_CASE(testParseFilesKeepsOrderAndErrors) {
+        const TempDirectory directory;
+        std::vector<std::string> paths;
+        std::vector<std::string> sources;
+        for (int i = 0; i < 40; i++) {
+            sources.push_back("let f = fn(x) { x * " + std::to_string(i) + " }; f(1 + " + std::to_string(i) + ");");
+            paths.push_back(directory.write("file" + std::to_string(i) + ".monkey", sources.back()));
+        }
+        paths.push_back(directory.write("broken.monkey", "let = 5;"));
+        paths.push_back((directory.path / "missing.monkey").string());
+        paths.push_back(directory.write("overflow.monkey", "99999999999999999999999;"));
+
+        const auto results = parseFiles(paths, 4);
+        BOOST_REQUIRE_EQUAL(paths.size(), results.size());
+        for (std::size_t i = 0; i < sources.size(); i++) {
+            BOOST_REQUIRE_EQUAL(paths[i], results[i].path);
+            BOOST_REQUIRE(results[i].errors.empty());
+            Parser parser{Lexer{sources[i]}};
+            const std::unique_ptr<Program> expected{parser.parseProgram()};
+            BOOST_REQUIRE_EQUAL(expected->to_string(), results[i].program->to_string());
+        }
+        const auto &broken = results[sources.size()];
+        BOOST_REQUIRE(broken.program != nullptr);
+        BOOST_REQUIRE_EQUAL("Expected next token to be IDENT, got ASSIGN instead", broken.errors[0]);
+        const auto &missing = results[sources.size() + 1];
+        BOOST_REQUIRE(missing.program == nullptr);
+        BOOST_REQUIRE_EQUAL(1, missing.errors.size());
+        const auto &overflow = results[sources.size() + 2];
+        BOOST_REQUIRE(overflow.program != nullptr);
+        BOOST_REQUIRE_EQUAL(1, overflow.errors.size());
+        BOOST_REQUIRE_EQUAL("could not parse 99999999999999999999999 as integer", overflow.errors[0]);
+    }
+
+    BOOST_AUTO_TEST_CASE(testParseFilesWithMoreThreadsThanFiles) {
+        const TempDirectory directory;
+        const auto results = parseFiles({directory.write("one.monkey", "1 + 2")}, 8);
+        BOOST_REQUIRE_EQUAL(1, results.size());
+        BOOST_REQUIRE_EQUAL("(1 + 2)", results[0].program->to_string());
+        BOOST_REQUIRE(parseFiles({}, 0).empty());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,125 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "constant_folding.h"
+#include "parser.h"
+
+namespace {
+    std::unique_ptr<Program> parseFold(const std::string &input, const ParserOptions options = {}) {
+        Parser parser{Lexer{input}, options};
+        std::unique_ptr<Program> program{parser.parseProgram()};
+        BOOST_REQUIRE(parser.errors.empty());
+        return program;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(ConstantFolding_suite)
+    BOOST_AUTO_TEST_CASE(testFoldsLiteralOperators) {
+        const std::pair<std::string, std::string> tests[] = {
+            {"(60 * 60 * 24) * 7", "604800"},
+            {"!true", "false"},
+            {"!!false", "false"},
+            {"!5", "false"},
+            {"!\"\"", "false"},
+            {"-(-5)", "5"},
+            {"10 / 3 - 2", "1"},
+            {"1 < 2 == true", "true"},
+            {"3 > 4 != false", "false"},
+            {"\"foo\" + \"bar\" + \"baz\"", "foobarbaz"},
+            {"let x = 2 * (3 + 4); x * (5 - 6)", "let x = 14;(x * -1)"},
+            {"[1 + 1, f(2 * 2)][0 + 0]", "([2, f(4)][0])"},
+            {"{\"a\" + \"b\": 1 - 1}", "{ab:0}"},
+            {"fn(x) { return x * (2 + 3); }", "fn(x) return (x * 5);"},
+        };
+        for (const auto &[input, expected]: tests) {
+            const auto program = parseFold(input);
+            const auto folded = foldConstants(*program);
+            BOOST_REQUIRE_EQUAL(expected, folded.program->to_string());
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testKeepsWhatWouldFailAtRuntime) {
+        const auto tests = {
+            "(1 / 0)",
+            "(9223372036854775807 + 1)",
+            "(1 + true)",
+            "(true + true)",
+            "(true < false)",
+            "(a == a)",
+            "(-true)",
+            "(-\"a\")",
+            "(x + 1)",
+        };
+        for (const auto input: tests) {
+            const auto program = parseFold(input);
+            const auto folded = foldConstants(*program);
+            BOOST_REQUIRE_EQUAL(program->to_string(), folded.program->to_string());
+            BOOST_REQUIRE_EQUAL(0, folded.eliminated);
+            // nothing changed, so the statements are the input's own
+            BOOST_REQUIRE_EQUAL(program->statements[0], folded.program->statements[0]);
+        }
+        // the operand folds, the subtraction would overflow
+        const auto overflow = parseFold("-9223372036854775807 - 2");
+        BOOST_REQUIRE_EQUAL("(-9223372036854775807 - 2)", foldConstants(*overflow).program->to_string());
+        // string equality isn't a Monkey operator, so it's left for the evaluator to report
+        const auto strings = parseFold("\"a\" == \"a\"");
+        BOOST_REQUIRE_EQUAL("(a == a)", foldConstants(*strings).program->to_string());
+    }
+
+    BOOST_AUTO_TEST_CASE(testPrunesConstantIfs) {
+        const std::pair<std::string, std::string> tests[] = {
+            {"if (true) { 1 } else { 2 }", "1"},
+            {"if (false) { 1 } else { 2 * 3 }", "6"},
+            {"if (1 < 2) { let x = 1; x } else { 0 }", "let x = 1;x"},
+            {"if (5) { a }", "a"},
+            {"if (!true) { a }", "if false "},
+            {"let y = if (false) { 1 } else { if (true) { \"t\" } };", "let y = t;"},
+            {"if (x) { 1 + 1 } else { 2 + 2 }", "if x 2 else 4"},
+        };
+        for (const auto &[input, expected]: tests) {
+            const auto program = parseFold(input);
+            BOOST_REQUIRE_EQUAL(expected, foldConstants(*program).program->to_string());
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testCountsEliminatedNodes) {
+        // expression statement, 3 infix expressions and 4 integers become a statement and an integer
+        auto program = parseFold("(60 * 60 * 24) * 7;");
+        BOOST_REQUIRE_EQUAL(6, foldConstants(*program).eliminated);
+
+        // the if, its condition, and both blocks with their statement and integer become one integer
+        program = parseFold("let a = if (true) { 1 } else { 2 };");
+        BOOST_REQUIRE_EQUAL(7, foldConstants(*program).eliminated);
+
+        program = parseFold("let a = fn(x) { x + 1 }; a(2);");
+        BOOST_REQUIRE_EQUAL(0, foldConstants(*program).eliminated);
+    }
+
+    BOOST_AUTO_TEST_CASE(testFoldedProgramOutlivesInput) {
+        auto program = parseFold("let s = \"a\" + \"b\"; let keep = [x, \"y\"]; fn(z) { z + 1 * 2 }");
+        const auto keep = program->statements[1];
+        auto folded = foldConstants(*program);
+        BOOST_REQUIRE_EQUAL(keep, folded.program->statements[1]);
+        program.reset();
+        BOOST_REQUIRE_EQUAL("let s = ab;let keep = [x, y];fn(z) (z + 2)", folded.program->to_string());
+    }
+
+    BOOST_AUTO_TEST_CASE(testHashConsedAndLazyInput) {
+        const auto source = "let a = (1 + 2) * (1 + 2); let b = fn() { 2 * 3 }; b() + (1 + 2)";
+        const auto shared = parseFold(source, ParserOptions{.hashConsing = true});
+        const auto eager = parseFold(source);
+        BOOST_REQUIRE_EQUAL(foldConstants(*eager).program->to_string(), foldConstants(*shared).program->to_string());
+
+        // deferred bodies stay deferred, and unfolded
+        const auto lazy = parseFold(source, ParserOptions{.lazyFunctionBodies = true});
+        const auto folded = foldConstants(*lazy);
+        const auto function = static_cast<const FunctionLiteral *>(
+            static_cast<const LetStatement *>(folded.program->statements[1])->value.value());
+        BOOST_REQUIRE(function->deferred());
+        BOOST_REQUIRE_EQUAL("let a = 9;let b = fn() (2 * 3);(b() + 3)", folded.program->to_string());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,151 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "flat_ast.h"
+#include "parser.h"
+
+std::unique_ptr<Program> parseFlat(const std::string &input) {
+    Parser parser{Lexer{input}};
+    std::unique_ptr<Program> program{parser.parseProgram()};
+    BOOST_REQUIRE(parser.errors.empty());
+    return program;
+}
+
+BOOST_AUTO_TEST_SUITE(FlatAst_suite)
+    BOOST_AUTO_TEST_CASE(testFlatAstPrintsLikeProgram) {
+        const auto tests = {
+            "let x = 5; let y = x; return x + y;",
+            "-a * b + !c",
+            "a + b * c + d / e - f",
+            "3 + 4 * 5 == 3 * 1 + 4 * 5",
+            "add(a, b, 1, 2 * 3, 4 + 5, add(6, 7 * 8))",
+            "a * [1, 2, 3, 4][b * c] * d",
+            "if (x < y) { x } else { y; return z; }",
+            "\"hello world\"; [\"a\", 1, true]",
+            "let add = fn(x, y) { x + y; }; add(1, fn() { 2 })",
+            "{\"one\": 1}[\"one\"]",
+        };
+        for (const auto input: tests) {
+            const auto program = parseFlat(input);
+            BOOST_REQUIRE_EQUAL(program->to_string(), FlatAst::from(*program).to_string());
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testFlatAstLayout) {
+        const auto program = parseFlat("let add = fn(x, y) { x + y; }; add(x, 42);");
+        const auto ast = FlatAst::from(*program);
+        BOOST_REQUIRE_EQUAL(2, ast.statements.count);
+
+        const auto &let = ast.node(ast.children(ast.statements)[0]);
+        BOOST_REQUIRE(let.kind == NodeKind::LET_STATEMENT);
+        BOOST_REQUIRE_EQUAL("add", ast.string(let.a));
+        const auto &function = ast.node(let.b);
+        BOOST_REQUIRE(function.kind == NodeKind::FUNCTION_LITERAL);
+        const auto parameters = ast.children(function.range());
+        BOOST_REQUIRE_EQUAL(2, parameters.size());
+        BOOST_REQUIRE_EQUAL("x", ast.string(ast.node(parameters[0]).a));
+        BOOST_REQUIRE_EQUAL("y", ast.string(ast.node(parameters[1]).a));
+        BOOST_REQUIRE(ast.node(function.a).kind == NodeKind::BLOCK_STATEMENT);
+
+        const auto &call = ast.node(ast.node(ast.children(ast.statements)[1]).a);
+        BOOST_REQUIRE(call.kind == NodeKind::CALL_EXPRESSION);
+        const auto arguments = ast.children(call.range());
+        BOOST_REQUIRE_EQUAL(2, arguments.size());
+        BOOST_REQUIRE_EQUAL(42, ast.integers[ast.node(arguments[1]).a]);
+
+        // "add", "x", "y" and "+" are interned once each
+        BOOST_REQUIRE_EQUAL(4, ast.stringCount());
+        // children always precede their parents
+        for (NodeIndex i = 0; i < ast.nodes.size(); i++) {
+            if (const auto &node = ast.nodes[i]; node.kind == NodeKind::INFIX_EXPRESSION) {
+                BOOST_REQUIRE(node.a < i);
+                BOOST_REQUIRE(node.c < i);
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testFlatAstHashLiteral) {
+        const auto program = parseFlat(R"({"one": 1})");
+        BOOST_REQUIRE_EQUAL("{one:1}", FlatAst::from(*program).to_string());
+    }
+
+    BOOST_AUTO_TEST_CASE(testFlatAstImageRoundTrip) {
+        const std::string source = R"(let add = fn(x, y) { x + y; };
+let s = "a string";
+if (add(1, 2) != 3) { return [1, -2][0]; } else { {"a": !true, 2: false} }
+add(s, 9223372036854775807)
+)";
+        const auto program = parseFlat(source);
+        const auto hash = FlatAst::hashSource(source);
+        std::stringstream image;
+        FlatAst::from(*program).write(image, hash);
+        BOOST_REQUIRE_EQUAL(0, image.str().size() % 8);
+
+        const auto ast = FlatAst::read(image.str(), hash);
+        BOOST_REQUIRE(ast.has_value());
+        BOOST_REQUIRE_EQUAL(program->to_string(), ast->to_string());
+        const std::unique_ptr<Program> inflated{ast->inflate()};
+        BOOST_REQUIRE(inflated->source == nullptr);
+        BOOST_REQUIRE_EQUAL(program->to_string(), inflated->to_string());
+        BOOST_REQUIRE_EQUAL(program->statements.size(), inflated->statements.size());
+        for (std::size_t i = 0; i < program->statements.size(); i++) {
+            BOOST_REQUIRE(*program->statements[i] == *inflated->statements[i]);
+            BOOST_REQUIRE(program->statements[i]->token.tokenType == inflated->statements[i]->token.tokenType);
+        }
+        const auto let = static_cast<const LetStatement *>(inflated->statements[0]);
+        BOOST_REQUIRE_EQUAL("add", let->name.token.literal);
+        const auto call = static_cast<const CallExpression *>(
+            static_cast<const ExpressionStatement *>(inflated->statements[3])->expression.value());
+        const auto number = call->arguments.value()[1].value();
+        BOOST_REQUIRE_EQUAL("9223372036854775807", number->token.literal);
+        BOOST_REQUIRE_EQUAL(9223372036854775807L, number->token.value);
+    }
+
+    BOOST_AUTO_TEST_CASE(testFlatAstImageIsRejected) {
+        const std::string source = "let x = fn(a) { a * 2 }; x(21);";
+        const auto program = parseFlat(source);
+        const auto hash = FlatAst::hashSource(source);
+        std::stringstream stream;
+        FlatAst::from(*program).write(stream, hash);
+        const auto image = stream.str();
+        BOOST_REQUIRE(FlatAst::read(image, hash).has_value());
+
+        // another source
+        BOOST_REQUIRE(!FlatAst::read(image, FlatAst::hashSource(source + " ")).has_value());
+        // truncated anywhere
+        for (std::size_t size = 0; size < image.size(); size += 4) {
+            BOOST_REQUIRE(!FlatAst::read(std::string_view{image}.substr(0, size), hash).has_value());
+        }
+        // another version
+        auto version = image;
+        version[8]++;
+        BOOST_REQUIRE(!FlatAst::read(version, hash).has_value());
+        // a node pointing forward, which could loop or run off the end
+        auto ast = FlatAst::from(*program);
+        ast.nodes.front().a = static_cast<NodeIndex>(ast.nodes.size());
+        ast.nodes.front().kind = NodeKind::EXPRESSION_STATEMENT;
+        std::stringstream forward;
+        ast.write(forward, hash);
+        BOOST_REQUIRE(!FlatAst::read(forward.str(), hash).has_value());
+        // children of the wrong kind where inflate() expects a body or a parameter
+        const auto function = FlatAst::from(*program);
+        const auto at = static_cast<std::size_t>(std::ranges::find(function.nodes, NodeKind::FUNCTION_LITERAL,
+                                                                   &FlatNode::kind) - function.nodes.begin());
+        BOOST_REQUIRE_LT(at, function.nodes.size());
+        auto body = function;
+        body.nodes[at].a = function.children(function.nodes[at].range())[0];
+        std::stringstream wrongBody;
+        body.write(wrongBody, hash);
+        BOOST_REQUIRE(!FlatAst::read(wrongBody.str(), hash).has_value());
+        auto parameter = function;
+        parameter.childIndices[function.nodes[at].range().first] = function.nodes[at].a;
+        std::stringstream wrongParameter;
+        parameter.write(wrongParameter, hash);
+        BOOST_REQUIRE(!FlatAst::read(wrongParameter.str(), hash).has_value());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,122 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "incremental.h"
+
+namespace {
+    const std::string SOURCE = R"(let five = 5;
+let add = fn(x, y) { x + y; };
+let s = "a { string }";
+if (add(1, 2) != 3) { return [1, 2][0]; } else { {"a": !true} }
+add(five, 10)
+-five
+return s;
+)";
+
+    // what a Parser gives for the same text from scratch
+    void requireFullParse(const IncrementalParser &incremental, const ParserOptions options = {}) {
+        auto parser = Parser(Lexer(std::string{incremental.text()}), options);
+        const std::unique_ptr<Program> expected{parser.parseProgram()};
+        BOOST_REQUIRE_EQUAL(expected->to_string(), incremental.program()->to_string());
+        const auto errors = incremental.errors();
+        BOOST_REQUIRE_EQUAL_COLLECTIONS(parser.errors.begin(), parser.errors.end(), errors.begin(), errors.end());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(Incremental_suite)
+    BOOST_AUTO_TEST_CASE(testEditsMatchFullParse) {
+        IncrementalParser incremental{SOURCE};
+        requireFullParse(incremental);
+        const auto edits = {
+            TextEdit{4, 4, "ten"},
+            TextEdit{0, 0, "  "},
+            TextEdit{SOURCE.size(), 0, "\nlet tail = 1"},
+            // removes a semicolon, so two statements become one
+            TextEdit{12, 1, ""},
+            // opens a string that swallows the rest of the text
+            TextEdit{20, 0, "\""},
+            TextEdit{20, 1, ""},
+            TextEdit{30, 40, ""},
+            TextEdit{5, 0, "= ;"},
+            TextEdit{0, 200, "1 + 2; 3"},
+            TextEdit{8, 0, " * 4"},
+        };
+        for (const auto &edit: edits) {
+            incremental.edit(edit);
+            requireFullParse(incremental);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testRandomEditsMatchFullParse) {
+        const std::vector<std::string> snippets = {
+            "", " ", ";", "\n", "x", "1", "+", "-", "(", ")", "{", "}", "\"", "let ", "return ", "fn(a) { a }",
+            "if (x) { y } else { z }", "[1, 2]", "{\"k\": 1}", "a b", "= 3;",
+        };
+        for (const auto lazy: {false, true}) {
+            const ParserOptions options{.lazyFunctionBodies = lazy};
+            IncrementalParser incremental{SOURCE, options};
+            std::mt19937 random{lazy ? 7u : 3u};
+            for (int i = 0; i < 300; i++) {
+                const auto size = incremental.text().size();
+                const auto offset = std::uniform_int_distribution<std::size_t>{0, size}(random);
+                const auto length = std::uniform_int_distribution<std::size_t>{0, std::min<std::size_t>(4, size - offset)}(
+                    random);
+                const auto &replacement = snippets[std::uniform_int_distribution<std::size_t>{
+                    0, snippets.size() - 1
+                }(random)];
+                incremental.edit(TextEdit{offset, length, replacement});
+                requireFullParse(incremental, options);
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testUntouchedStatementsAreReused) {
+        std::string source;
+        for (int i = 0; i < 100; i++) {
+            source += "let v = [" + std::to_string(i) + ", fn(x) { x * 2 }];\n";
+        }
+        IncrementalParser incremental{source};
+        const auto before = incremental.program();
+        BOOST_REQUIRE_EQUAL(100, before->statements.size());
+        BOOST_REQUIRE_EQUAL(100, incremental.reparsed());
+
+        const auto edited = source.find("[50,") + 1;
+        const auto after = incremental.edit(TextEdit{edited, 2, "12345"});
+        requireFullParse(incremental);
+        BOOST_REQUIRE_LE(incremental.reparsed(), 2);
+        BOOST_REQUIRE_EQUAL(100, after->statements.size());
+        for (std::size_t i = 0; i < 100; i++) {
+            if (i != 49 && i != 50) {
+                BOOST_REQUIRE_EQUAL(before->statements[i], after->statements[i]);
+            }
+        }
+        BOOST_REQUIRE_NE(before->statements[50], after->statements[50]);
+        // the earlier Program still holds on to its own text and nodes
+        BOOST_REQUIRE_EQUAL("let v = [50, fn(x) (x * 2)];", before->statements[50]->to_string());
+        BOOST_REQUIRE_EQUAL("let v = [12345, fn(x) (x * 2)];", after->statements[50]->to_string());
+    }
+
+    BOOST_AUTO_TEST_CASE(testManyEditsStayBounded) {
+        std::string source;
+        for (int i = 0; i < 50; i++) {
+            source += "let a = " + std::to_string(i) + ";\n";
+        }
+        IncrementalParser incremental{source};
+        for (int i = 0; i < 200; i++) {
+            // a different statement each time, so every edit leaves another text behind until a full parse
+            const auto statement = static_cast<std::size_t>(i * 7 % 50);
+            const auto offset = incremental.text().find("let", statement * 10);
+            incremental.edit(TextEdit{offset + 4, 1, "b"});
+            incremental.edit(TextEdit{offset + 4, 1, "a"});
+        }
+        requireFullParse(incremental);
+        const auto texts = std::static_pointer_cast<const std::vector<std::shared_ptr<const std::string> > >(
+            incremental.program()->source);
+        BOOST_REQUIRE_LE(texts->size(), INCREMENTAL_MAX_TEXTS + 1);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
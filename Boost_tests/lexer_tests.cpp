@@ -4,6 +4,7 @@
 #include "lexer.h"
 #include "tokens.h"
 #include <iostream>
+#include <tuple>
 
 BOOST_AUTO_TEST_SUITE(Lexer_suite)
     BOOST_AUTO_TEST_CASE(testValidateLexer) {
@@ -122,8 +123,67 @@ BOOST_AUTO_TEST_SUITE(Lexer_suite)
 
         for (const auto &[fst, snd]: expected) {
             const auto token = lexer->nextToken();
-            BOOST_REQUIRE(token->tokenType == fst);
-            BOOST_REQUIRE_EQUAL(token->literal, snd);
+            BOOST_REQUIRE(token.tokenType == fst);
+            BOOST_REQUIRE_EQUAL(token.literal, snd);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testIllegalCharacters) {
+        const auto lexer = new Lexer("@let $ x");
+        const auto expected = {
+            std::pair{TokenType::ILLEGAL, "@"},
+            std::pair{TokenType::LET, "let"},
+            std::pair{TokenType::ILLEGAL, "$"},
+            std::pair{TokenType::IDENT, "x"},
+            std::pair{TokenType::EOF_, ""},
+        };
+
+        for (const auto &[fst, snd]: expected) {
+            const auto token = lexer->nextToken();
+            BOOST_REQUIRE(token.tokenType == fst);
+            BOOST_REQUIRE_EQUAL(token.literal, snd);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testIntegerValues) {
+        Lexer lexer{"0 42 9223372036854775807 9223372036854775808 99999999999999999999999"};
+        const auto expected = {
+            std::tuple{0L, true},
+            std::tuple{42L, true},
+            std::tuple{9223372036854775807L, true},
+            std::tuple{0L, false},
+            std::tuple{0L, false},
+        };
+
+        for (const auto &[value, inRange]: expected) {
+            const auto token = lexer.nextToken();
+            BOOST_REQUIRE(token.tokenType == TokenType::INT);
+            BOOST_REQUIRE_EQUAL(value, token.value);
+            BOOST_REQUIRE_EQUAL(inRange, token.inRange);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testLookupIdent) {
+        const auto expected = {
+            std::pair{"fn", TokenType::FUNCTION},
+            std::pair{"let", TokenType::LET},
+            std::pair{"true", TokenType::TRUE},
+            std::pair{"false", TokenType::FALSE},
+            std::pair{"if", TokenType::IF},
+            std::pair{"else", TokenType::ELSE},
+            std::pair{"return", TokenType::RETURN},
+            std::pair{"", TokenType::IDENT},
+            std::pair{"f", TokenType::IDENT},
+            std::pair{"fm", TokenType::IDENT},
+            std::pair{"lets", TokenType::IDENT},
+            std::pair{"nf", TokenType::IDENT},
+            std::pair{"ture", TokenType::IDENT},
+            std::pair{"returned", TokenType::IDENT},
+            std::pair{"ELSE", TokenType::IDENT},
+        };
+
+        for (const auto &[literal, tokenType]: expected) {
+            BOOST_REQUIRE(lookupIdent(literal) == tokenType);
         }
     }
 
@@ -0,0 +1,57 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include "mapped_file.h"
+#include "parser.h"
+
+namespace {
+    std::string writeTempFile(const std::string &name, const std::string &content) {
+        const auto path = (std::filesystem::temp_directory_path() / name).string();
+        std::ofstream{path} << content;
+        return path;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(MappedFile_suite)
+    BOOST_AUTO_TEST_CASE(testLexerOverStringView) {
+        const std::string source = "let x = 5; x";
+        Lexer lexer{std::string_view{source}};
+        BOOST_REQUIRE(lexer.source() == nullptr);
+        const auto token = lexer.nextToken();
+        BOOST_REQUIRE(token.tokenType == TokenType::LET);
+        BOOST_REQUIRE(source.data() == token.literal.data());
+    }
+
+    BOOST_AUTO_TEST_CASE(testProgramKeepsMappingAlive) {
+        const auto path = writeTempFile("pitaya_mapped.monkey", "let add = fn(a, b) { a + b }; add(\"x\", 2);");
+        std::weak_ptr<const void> mapping;
+        std::unique_ptr<Program> program;
+        {
+            Parser parser{lexFile(path)};
+            program.reset(parser.parseProgram());
+            BOOST_REQUIRE(parser.errors.empty());
+            mapping = program->source;
+        }
+        std::filesystem::remove(path);
+        BOOST_REQUIRE(!mapping.expired());
+        BOOST_REQUIRE_EQUAL("let add = fn(a, b) (a + b);add(x, 2)", program->to_string());
+        const auto let = dynamic_cast<LetStatement *>(program->statements[0]);
+        BOOST_REQUIRE_EQUAL("let", let->tokenLiteral());
+        program.reset();
+        BOOST_REQUIRE(mapping.expired());
+    }
+
+    BOOST_AUTO_TEST_CASE(testEmptyAndMissingFiles) {
+        const auto path = writeTempFile("pitaya_empty.monkey", "");
+        auto lexer = lexFile(path);
+        BOOST_REQUIRE(lexer.nextToken().tokenType == TokenType::EOF_);
+        std::filesystem::remove(path);
+        BOOST_REQUIRE_THROW(MappedFile::open(path), std::system_error);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
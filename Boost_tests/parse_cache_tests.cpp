@@ -0,0 +1,100 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parse_cache.h"
+
+BOOST_AUTO_TEST_SUITE(ParseCache_suite)
+    BOOST_AUTO_TEST_CASE(testRepeatedSourcesAreShared) {
+        ParseCache cache{1 << 20};
+        std::string source = "let add = fn(a, b) { a + b }; add(1, 2);";
+        const auto first = cache.parse(source);
+        BOOST_REQUIRE(first->errors.empty());
+        BOOST_REQUIRE_EQUAL("let add = fn(a, b) (a + b);add(1, 2)", first->program->to_string());
+
+        // the cache keeps its own copy of the text
+        const auto copy = source;
+        source.assign(source.size(), 'x');
+        const auto second = cache.parse(copy);
+        BOOST_REQUIRE_EQUAL(first, second);
+        BOOST_REQUIRE_EQUAL("let add = fn(a, b) (a + b);add(1, 2)", second->program->to_string());
+
+        const auto broken = cache.parse("let = 1;");
+        BOOST_REQUIRE(!broken->errors.empty());
+        BOOST_REQUIRE_EQUAL(broken, cache.parse("let = 1;"));
+
+        const auto stats = cache.stats();
+        BOOST_REQUIRE_EQUAL(2, stats.hits);
+        BOOST_REQUIRE_EQUAL(2, stats.misses);
+        BOOST_REQUIRE_EQUAL(0, stats.evictions);
+        BOOST_REQUIRE_EQUAL(2, stats.entries);
+        BOOST_REQUIRE_EQUAL(first->bytes + broken->bytes, stats.bytes);
+        // charged for whole chunks, not just the bytes used in them
+        BOOST_REQUIRE_GT(first->bytes,
+                         first->program->arena->bytesReserved() + first->program->symbols->bytesReserved());
+        BOOST_REQUIRE_LT(first->program->arena->bytesReserved(), DEFAULT_ARENA_CHUNK_SIZE);
+
+        cache.clear();
+        BOOST_REQUIRE_EQUAL(0, cache.stats().entries);
+        BOOST_REQUIRE_EQUAL(0, cache.stats().bytes);
+        BOOST_REQUIRE_EQUAL(0, cache.stats().hits);
+        BOOST_REQUIRE_EQUAL(0, cache.stats().misses);
+        BOOST_REQUIRE_NE(first, cache.parse(copy));
+        BOOST_REQUIRE_EQUAL(1, cache.stats().misses);
+    }
+
+    BOOST_AUTO_TEST_CASE(testLeastRecentlyUsedIsEvicted) {
+        const auto sized = ParseCache{1 << 20}.parse("let a = 1;");
+        const auto size = sized->bytes;
+        BOOST_REQUIRE_GE(size, sized->program->arena->bytesReserved() + sized->program->symbols->bytesReserved());
+        // room for two programs of that size
+        ParseCache cache{2 * size + size / 2};
+        const auto a = cache.parse("let a = 1;");
+        const auto b = cache.parse("let b = 1;");
+        BOOST_REQUIRE_EQUAL(a, cache.parse("let a = 1;"));
+        cache.parse("let c = 1;");
+        BOOST_REQUIRE_EQUAL(1, cache.stats().evictions);
+        BOOST_REQUIRE_EQUAL(2, cache.stats().entries);
+        BOOST_REQUIRE_LE(cache.stats().bytes, 2 * size + size / 2);
+        // b was the least recently used, a is still there
+        BOOST_REQUIRE_EQUAL(a, cache.parse("let a = 1;"));
+        BOOST_REQUIRE_NE(b, cache.parse("let b = 1;"));
+        // a Program outliving its entry is still whole
+        BOOST_REQUIRE_EQUAL("let b = 1;", b->program->to_string());
+
+        // too big to keep at all
+        const auto large = cache.parse("let large = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16];");
+        BOOST_REQUIRE_GT(large->bytes, 2 * size + size / 2);
+        BOOST_REQUIRE_GE(large->bytes, large->program->arena->bytesReserved());
+        BOOST_REQUIRE_EQUAL(2, cache.stats().entries);
+        BOOST_REQUIRE_NE(large, cache.parse("let large = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16];"));
+    }
+
+    BOOST_AUTO_TEST_CASE(testParseFromSeveralThreads) {
+        ParseCache cache{1 << 20};
+        const std::vector<std::string> sources = {"1 + 2", "fn(x) { x * 2 }(21)", "[1, 2][0]", "if (true) { 1 }"};
+        // Boost.Test checks aren't thread-safe, so the threads only count what went wrong
+        std::atomic<int> failures = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&cache, &sources, &failures, t] {
+                for (int i = 0; i < 1000; i++) {
+                    const auto &source = sources[static_cast<std::size_t>(i + t) % sources.size()];
+                    failures += !cache.parse(source)->errors.empty();
+                }
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        BOOST_REQUIRE_EQUAL(0, failures.load());
+        const auto stats = cache.stats();
+        BOOST_REQUIRE_EQUAL(4000, stats.hits + stats.misses);
+        BOOST_REQUIRE_EQUAL(4, stats.entries);
+        BOOST_REQUIRE_EQUAL(0, stats.evictions);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,61 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <string>
+
+#include "parser_session.h"
+
+BOOST_AUTO_TEST_SUITE(ParserSession_suite)
+    BOOST_AUTO_TEST_CASE(testSessionParsesLikeParser) {
+        ParserSession session;
+        const auto inputs = {
+            "let add = fn(a, b) { a + b }; add(1, 2);",
+            "let = 1;",
+            "\"a\" + \"b\"; [1, 2][0]; {\"k\": true}",
+            "if (x) { y } else { z }",
+        };
+        for (const auto input: inputs) {
+            Parser parser{Lexer{input}};
+            const std::unique_ptr<Program> expected{parser.parseProgram()};
+            const auto program = session.parse(input);
+            BOOST_REQUIRE_EQUAL(expected->to_string(), program->to_string());
+            BOOST_REQUIRE_EQUAL_COLLECTIONS(parser.errors.begin(), parser.errors.end(), session.errors().begin(),
+                                            session.errors().end());
+        }
+        BOOST_REQUIRE_EQUAL(3, session.recycled());
+    }
+
+    BOOST_AUTO_TEST_CASE(testMemoryLevelsOff) {
+        ParserSession session;
+        std::string source;
+        for (int i = 0; i < 200; i++) {
+            source += "let v = fn(x) { x * " + std::to_string(i) + " };\n";
+        }
+        session.parse(source);
+        const auto reserved = session.bytesReserved();
+        for (int i = 0; i < 50; i++) {
+            BOOST_REQUIRE_EQUAL(200, session.parse(source)->statements.size());
+            BOOST_REQUIRE_EQUAL(reserved, session.bytesReserved());
+        }
+        BOOST_REQUIRE_EQUAL(50, session.recycled());
+    }
+
+    BOOST_AUTO_TEST_CASE(testKeptProgramStaysValid) {
+        ParserSession session{{}, 1024};
+        const auto kept = session.parse("let a = \"kept\"; a");
+        const auto next = session.parse("let b = \"next\"; b");
+        BOOST_REQUIRE_EQUAL(0, session.recycled());
+        BOOST_REQUIRE_EQUAL("let a = kept;a", kept->to_string());
+        BOOST_REQUIRE_EQUAL("let b = next;b", next->to_string());
+
+        // a large input once doesn't keep more than retainBytes around
+        std::string large;
+        for (int i = 0; i < 1000; i++) {
+            large += "[" + std::to_string(i) + ", \"" + std::to_string(i) + "\"];";
+        }
+        session.parse(large);
+        session.parse("1");
+        BOOST_REQUIRE_LE(session.bytesReserved(), DEFAULT_ARENA_CHUNK_SIZE + 1024);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
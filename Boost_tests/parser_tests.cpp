@@ -2,6 +2,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/any.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <thread>
 #include <utility>
 #include <variant>
 #include <iostream>
@@ -262,6 +263,19 @@ BOOST_AUTO_TEST_SUITE(Parser_suite)
         }
     }
 
+    BOOST_AUTO_TEST_CASE(testFunctionAndHashPrinting) {
+        const auto tests = {
+            std::tuple{"fn(x, y) { x + y; }", "fn(x, y) (x + y)"},
+            std::tuple{"fn() { return 1; }", "fn() return 1;"},
+            std::tuple{R"({"one": 1 + 2})", "{one:(1 + 2)}"},
+            std::tuple{"{}", "{}"},
+        };
+        for (auto &[input, expected]: tests) {
+            const auto program = createProgram(input);
+            BOOST_REQUIRE_EQUAL(program->to_string(), expected);
+        }
+    }
+
     BOOST_AUTO_TEST_CASE(testBooleanExpressions) {
         const auto tests = {
             std::tuple{"true", true},
@@ -310,7 +324,7 @@ BOOST_AUTO_TEST_SUITE(Parser_suite)
             } else {
                 BOOST_FAIL("empty parameters");
             }
-            processT(function->body, [](const BlockStatement *body) {
+            processT(function->body(), [](const BlockStatement *body) {
                 if (const auto opt_statements = body->statements; opt_statements.has_value()) {
                     const auto &statements = opt_statements.value();
                     BOOST_REQUIRE_EQUAL(1, statements.size());
@@ -327,9 +341,9 @@ BOOST_AUTO_TEST_SUITE(Parser_suite)
 
     BOOST_AUTO_TEST_CASE(testFunctionParameters) {
         const auto tests = {
-            std::tuple<std::string, std::initializer_list<std::string> >{"fn (){}", {}},
-            std::tuple<std::string, std::initializer_list<std::string> >{"fn (x){}", {"x"}},
-            std::tuple<std::string, std::initializer_list<std::string> >{"fn (x, y, z){}", {"x", "y", "z"}},
+            std::tuple<std::string, std::vector<std::string> >{"fn (){}", {}},
+            std::tuple<std::string, std::vector<std::string> >{"fn (x){}", {"x"}},
+            std::tuple<std::string, std::vector<std::string> >{"fn (x, y, z){}", {"x", "y", "z"}},
         };
 
         for (auto &[input, expected_parameters]: tests) {
@@ -420,4 +434,361 @@ BOOST_AUTO_TEST_SUITE(Parser_suite)
 
 }
 
+    BOOST_AUTO_TEST_CASE(testStructuralEquality) {
+        const auto input = "let a = add(1 + x, [y, \"s\"])[0]; if (a) { fn(x) { x } } else { {1: true} }";
+        const auto first = createProgram(input);
+        const auto second = createProgram(input);
+        BOOST_REQUIRE_EQUAL(first->statements.size(), second->statements.size());
+        for (std::size_t i = 0; i < first->statements.size(); i++) {
+            const auto a = first->statements[i];
+            const auto b = second->statements[i];
+            BOOST_REQUIRE_NE(a, b);
+            BOOST_CHECK(*a == *b);
+            BOOST_CHECK_EQUAL(a->hash(), b->hash());
+            BOOST_CHECK(!(*a < *b) && !(*b < *a));
+        }
+        const auto other = createProgram("let a = add(1 + x, [y, \"t\"])[0];");
+        BOOST_CHECK(!(*first->statements[0] == *other->statements[0]));
+        BOOST_CHECK((*first->statements[0] < *other->statements[0]) != (*other->statements[0] < *first->statements[0]));
+    }
+
+    BOOST_AUTO_TEST_CASE(testStructuralOrdering) {
+        const auto program = createProgram("1; 2; x; \"a\"; 1 + 2; 1; -x; x; 2 * 3;");
+        std::vector<Statement *> expressions;
+        for (const auto statement: program->statements) {
+            expressions.push_back(dynamic_cast<ExpressionStatement *>(statement)->expression.value());
+        }
+        std::ranges::sort(expressions, StatementLess{});
+        for (std::size_t i = 1; i < expressions.size(); i++) {
+            const auto &previous = *expressions[i - 1];
+            const auto &current = *expressions[i];
+            BOOST_CHECK(!(current < previous));
+            BOOST_CHECK_EQUAL(previous == current, !(previous < current));
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testHashLiteralDuplicateKeys) {
+        const auto program = createProgram(R"({"one": 1, "two": 2, "one": 3})");
+        processCast<HashLiteral *>(program, [](const HashLiteral *hash) {
+            BOOST_REQUIRE_EQUAL(3, hash->pairs.size());
+            BOOST_CHECK_EQUAL("{one:1, two:2, one:3}", hash->to_string());
+        });
+        // every key is kept in source order, even equal ones whose evaluation may have side effects
+        const auto calls = createProgram("{f(): 1, f(): 2}");
+        processCast<HashLiteral *>(calls, [](const HashLiteral *hash) {
+            BOOST_REQUIRE_EQUAL(2, hash->pairs.size());
+            BOOST_CHECK(*hash->pairs[0].first == *hash->pairs[1].first);
+            BOOST_CHECK_EQUAL("{f():1, f():2}", hash->to_string());
+        });
+    }
+
+    BOOST_AUTO_TEST_CASE(testHashConsing) {
+        const auto input = "let a = f(x + 1, [x, 2]); let b = f(x + 1, [x, 2]); let c = fn(x) { x + 1 };";
+        const auto value = [](const Program *program, const std::size_t i) {
+            return dynamic_cast<LetStatement *>(program->statements[i])->value.value();
+        };
+        auto parser = Parser(Lexer(input), ParserOptions{.hashConsing = true});
+        const auto program = parser.parseProgram();
+        checkParserErrors(parser);
+        BOOST_CHECK_EQUAL(value(program, 0), value(program, 1));
+        const auto function = dynamic_cast<FunctionLiteral *>(value(program, 2));
+        const auto body = dynamic_cast<ExpressionStatement *>(function->body().value()->statements->at(0).value());
+        const auto call = dynamic_cast<CallExpression *>(value(program, 0));
+        BOOST_CHECK_EQUAL(body->expression.value(), call->arguments->at(0).value());
+        BOOST_CHECK_EQUAL(program->to_string(), createProgram(input)->to_string());
+
+        const auto unshared = createProgram(input);
+        BOOST_CHECK_NE(value(unshared, 0), value(unshared, 1));
+        BOOST_CHECK(*value(unshared, 0) == *value(unshared, 1));
+    }
+
+    BOOST_AUTO_TEST_CASE(testHashConsingLeavesBodiesDeferred) {
+        const auto input = "map(arr, fn(x) { x * 2 }); [fn() { 1 }]; {1: fn() { 2 }}; f(x + 1, fn() { 3 })";
+        auto parser = Parser(Lexer(input), ParserOptions{.hashConsing = true, .lazyFunctionBodies = true});
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+        checkParserErrors(parser);
+        std::vector<const FunctionLiteral *> functions;
+        const auto collect = [&functions](const std::optional<Statement *> node) {
+            if (const auto function = dynamic_cast<const FunctionLiteral *>(node.value_or(nullptr))) {
+                functions.push_back(function);
+            }
+        };
+        for (const auto statement: program->statements) {
+            const auto expression = dynamic_cast<ExpressionStatement *>(statement)->expression.value();
+            if (const auto call = dynamic_cast<CallExpression *>(expression)) {
+                std::ranges::for_each(call->arguments.value(), collect);
+            } else if (const auto array = dynamic_cast<ArrayLiteral *>(expression)) {
+                std::ranges::for_each(array->elements.value(), collect);
+            } else if (const auto hash = dynamic_cast<HashLiteral *>(expression)) {
+                collect(hash->pairs[0].second);
+            }
+        }
+        BOOST_REQUIRE_EQUAL(4, functions.size());
+        for (const auto function: functions) {
+            BOOST_CHECK(function->deferred());
+        }
+        BOOST_CHECK_EQUAL("map(arr, fn(x) (x * 2))[fn() 1]{1:fn() 2}f((x + 1), fn() 3)", program->to_string());
+    }
+
+    BOOST_AUTO_TEST_CASE(testFailedInfixParseIsReported) {
+        auto parser = Parser(Lexer("a[1 + 2; b(1, 2"));
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+        BOOST_REQUIRE_EQUAL(2, parser.errors.size());
+        BOOST_REQUIRE_EQUAL("Expected next token to be RBRACKET, got SEMICOLON instead", parser.errors[0]);
+    }
+
+    BOOST_AUTO_TEST_CASE(testIntegerOverflowIsReported) {
+        auto parser = Parser(Lexer("let a = 99999999999999999999999; 5;"));
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+        BOOST_REQUIRE_EQUAL(1, parser.errors.size());
+        BOOST_REQUIRE_EQUAL("could not parse 99999999999999999999999 as integer", parser.errors[0]);
+        BOOST_REQUIRE_EQUAL("5", program->statements.back()->to_string());
+    }
+
+    BOOST_AUTO_TEST_CASE(testExplicitStackMatchesRecursiveParser) {
+        const auto inputs = {
+            "-a * b; !-a; a + b * c + d / e - f; 3 + 4; -5 * 5",
+            "5 > 4 == 3 < 4; 3 + 4 * 5 == 3 * 1 + 4 * 5; 3 > 5 == false",
+            "1 + (2 + 3) + 4; (5 + 5) * 2 * (5 + 5); -(5 + 5); !(true == true); ((((a))))",
+            "a + add(b * c) + d; add(a, b, 1, 2 * 3, 4 + 5, add(6, 7 * 8)); -f(x)[1] * !g[2](3)",
+            "a * [1, 2, 3, 4][b * c] * d; add(a * b[2], b[1], 2 * [1, 2][1])",
+            "let x = if (-a < (b)) { -(c) } else { fn(y) { !(y + 1) } }; return {-1: (2)};",
+            "(1 + 2; -; a + ; (; !(; a[1 + 2; 1 + * 2; -)",
+        };
+        for (const auto input: inputs) {
+            auto recursive = Parser(Lexer(input));
+            const std::unique_ptr<Program> expected{recursive.parseProgram()};
+            auto iterative = Parser(Lexer(input), ParserOptions{.explicitStack = true});
+            const std::unique_ptr<Program> program{iterative.parseProgram()};
+            BOOST_REQUIRE_EQUAL(expected->to_string(), program->to_string());
+            BOOST_REQUIRE_EQUAL_COLLECTIONS(recursive.errors.begin(), recursive.errors.end(),
+                                            iterative.errors.begin(), iterative.errors.end());
+        }
+    }
+
+    const FunctionLiteral *functionAt(const Program &program, const std::size_t index) {
+        const auto let = dynamic_cast<LetStatement *>(program.statements.at(index));
+        return dynamic_cast<const FunctionLiteral *>(let->value.value());
+    }
+
+    BOOST_AUTO_TEST_CASE(testLazyFunctionBodiesMatchEagerParse) {
+        const std::string input = R"(let add = fn(x, y) { x + y; };
+let braces = fn() { let s = "}{ }"; if (s == "{") { {"a": fn() { 1 }} } else { [] } };
+let empty = fn() {};
+let nested = fn(f) { fn(x) { f(fn() { x }) } }(add);
+add(1, 2);)";
+        auto eager = Parser(Lexer(input));
+        const std::unique_ptr<Program> expected{eager.parseProgram()};
+        checkParserErrors(eager);
+        for (const auto preLex: {false, true}) {
+            auto lazy = Parser(Lexer(input), ParserOptions{.preLex = preLex, .lazyFunctionBodies = true});
+            const std::unique_ptr<Program> program{lazy.parseProgram()};
+            checkParserErrors(lazy);
+            BOOST_REQUIRE_EQUAL(expected->statements.size(), program->statements.size());
+            BOOST_REQUIRE(functionAt(*program, 0)->deferred());
+            BOOST_REQUIRE(functionAt(*program, 1)->deferred());
+            for (std::size_t i = 0; i < program->statements.size(); i++) {
+                BOOST_REQUIRE(*expected->statements[i] == *program->statements[i]);
+            }
+            BOOST_REQUIRE(!functionAt(*program, 0)->deferred());
+            BOOST_REQUIRE_EQUAL(expected->to_string(), program->to_string());
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testLazyFunctionBodyErrors) {
+        auto parser = Parser(Lexer("let f = fn() { let = 1; }; let g = fn() { let = 2; \"}; 5"),
+                             ParserOptions{.lazyFunctionBodies = true});
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+        // the unterminated string leaves g's brace unmatched, so g is parsed right away and reports to the parser
+        BOOST_REQUIRE_EQUAL(2, parser.errors.size());
+        const auto f = functionAt(*program, 0);
+        BOOST_REQUIRE(f->deferred());
+        BOOST_REQUIRE(f->bodyErrors().empty());
+        BOOST_REQUIRE(f->body().has_value());
+        BOOST_REQUIRE_EQUAL(2, f->bodyErrors().size());
+        BOOST_REQUIRE_EQUAL("Expected next token to be IDENT, got ASSIGN instead", f->bodyErrors()[0]);
+        BOOST_REQUIRE(!functionAt(*program, 1)->deferred());
+    }
+
+    BOOST_AUTO_TEST_CASE(testLazyFunctionBodiesFromSeveralThreads) {
+        std::string input;
+        for (auto name = 'a'; name <= 'z'; name++) {
+            input += std::string{"let "} + name + " = fn(x) { fn(y) { x + y * " + std::to_string(name - 'a') + " } };\n";
+        }
+        auto parser = Parser(Lexer(input), ParserOptions{.hashConsing = true, .lazyFunctionBodies = true});
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+        checkParserErrors(parser);
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&program] {
+                for (std::size_t i = 0; i < program->statements.size(); i++) {
+                    const auto body = functionAt(*program, i)->body().value();
+                    const auto inner = dynamic_cast<ExpressionStatement *>(body->statements->at(0).value());
+                    static_cast<void>(inner->expression.value()->hash());
+                }
+            });
+        }
+        threads.clear();
+        auto eager = Parser(Lexer(input));
+        const std::unique_ptr<Program> expected{eager.parseProgram()};
+        BOOST_REQUIRE_EQUAL(expected->to_string(), program->to_string());
+    }
+
+    // Follows `next` from the statement's expression without recursion, returning how many links it took
+    template<typename Next>
+    std::size_t chainLength(const Program &program, Next next) {
+        BOOST_REQUIRE_EQUAL(1, program.statements.size());
+        auto node = dynamic_cast<ExpressionStatement *>(program.statements[0])->expression;
+        std::size_t length = 0;
+        while (node.has_value()) {
+            const auto following = next(node.value());
+            if (!following.has_value()) {
+                break;
+            }
+            node = following;
+            length++;
+        }
+        return length;
+    }
+
+    std::unique_ptr<Program> parseDeep(const std::string &input) {
+        auto parser = Parser(Lexer(input), ParserOptions{.explicitStack = true});
+        std::unique_ptr<Program> program{parser.parseProgram()};
+        checkParserErrors(parser);
+        return program;
+    }
+
+    constexpr std::size_t DEEP_NESTING = 100000;
+
+    BOOST_AUTO_TEST_CASE(testDeeplyNestedParentheses) {
+        const auto program = parseDeep(std::string(DEEP_NESTING, '(') + "1 + 2" + std::string(DEEP_NESTING, ')'));
+        const auto infix = dynamic_cast<InfixExpression *>(
+            dynamic_cast<ExpressionStatement *>(program->statements[0])->expression.value());
+        BOOST_REQUIRE(infix != nullptr);
+        testLongLiteral(infix->left, 1);
+        testLongLiteral(infix->right, 2);
+    }
+
+    BOOST_AUTO_TEST_CASE(testDeepPrefixChains) {
+        std::string input;
+        for (std::size_t i = 0; i < DEEP_NESTING; i++) {
+            input += i % 3 == 0 ? "-" : i % 3 == 1 ? "!" : "(";
+        }
+        input += "x" + std::string(DEEP_NESTING / 3, ')');
+        const auto program = parseDeep(input);
+        const auto length = chainLength(*program, [](Statement *node) -> std::optional<Statement *> {
+            if (const auto prefix = dynamic_cast<PrefixExpression *>(node); prefix != nullptr) {
+                return prefix->right;
+            }
+            return std::nullopt;
+        });
+        BOOST_REQUIRE_EQUAL(DEEP_NESTING - DEEP_NESTING / 3, length);
+    }
+
+    BOOST_AUTO_TEST_CASE(testDeepRightNestedInfix) {
+        std::string input;
+        for (std::size_t i = 0; i < DEEP_NESTING; i++) {
+            input += "a + (";
+        }
+        input += "b" + std::string(DEEP_NESTING, ')');
+        const auto program = parseDeep(input);
+        const auto length = chainLength(*program, [](Statement *node) -> std::optional<Statement *> {
+            if (const auto infix = dynamic_cast<InfixExpression *>(node); infix != nullptr) {
+                testIdentifier(infix->left, "a");
+                return infix->right;
+            }
+            return std::nullopt;
+        });
+        BOOST_REQUIRE_EQUAL(DEEP_NESTING, length);
+    }
+
+    std::string repeat(const std::string &text, const std::size_t count) {
+        std::string repeated;
+        for (std::size_t i = 0; i < count; i++) {
+            repeated += text;
+        }
+        return repeated;
+    }
+
+    BOOST_AUTO_TEST_CASE(testNestingLimit) {
+        constexpr std::size_t nesting = 5000;
+        // whether explicitStack parses the shape without recursing
+        const std::pair<std::string, bool> inputs[] = {
+            {repeat("(", nesting) + "1" + repeat(")", nesting), true},
+            {repeat("-", nesting) + "1", true},
+            {repeat("a + (", nesting) + "1" + repeat(")", nesting), true},
+            {repeat("f(", nesting) + "1" + repeat(")", nesting), false},
+            {repeat("[", nesting) + "1" + repeat("]", nesting), false},
+            {repeat("a[", nesting) + "1" + repeat("]", nesting), false},
+            {repeat("{1: ", nesting) + "1" + repeat("}", nesting), false},
+            {repeat("if (x) { ", nesting) + "1" + repeat(" }", nesting), false},
+            {repeat("fn() { ", nesting) + "1" + repeat(" }", nesting), false},
+        };
+        for (const auto &[input, iterative]: inputs) {
+            for (const auto explicitStack: {false, true}) {
+                auto parser = Parser(Lexer(input), ParserOptions{.explicitStack = explicitStack});
+                const std::unique_ptr<Program> program{parser.parseProgram()};
+                if (explicitStack && iterative) {
+                    checkParserErrors(parser);
+                    continue;
+                }
+                BOOST_REQUIRE_EQUAL(1, parser.errors.size());
+                BOOST_REQUIRE_EQUAL("nesting deeper than 1000 levels", parser.errors[0]);
+                // what is left can be walked recursively
+                static_cast<void>(program->to_string());
+                for (const auto statement: program->statements) {
+                    static_cast<void>(statement->hash());
+                }
+            }
+        }
+
+        // a left-associative chain is parsed in a loop, however long it is
+        for (const auto explicitStack: {false, true}) {
+            auto parser = Parser(Lexer("1" + repeat(" + 1", nesting) + "; 2"),
+                                 ParserOptions{.explicitStack = explicitStack});
+            const std::unique_ptr<Program> program{parser.parseProgram()};
+            checkParserErrors(parser);
+            BOOST_REQUIRE_EQUAL(2, program->statements.size());
+        }
+
+        // counted in calls under way, from the statement down
+        const auto errors = [](const std::string &input, const std::size_t maxDepth) {
+            auto parser = Parser(Lexer(input), ParserOptions{.maxDepth = maxDepth});
+            const std::unique_ptr<Program> program{parser.parseProgram()};
+            return parser.errors.size();
+        };
+        BOOST_CHECK_EQUAL(0, errors("let x = 1;", 2));
+        BOOST_CHECK_EQUAL(1, errors("let x = 1;", 1));
+        BOOST_CHECK_EQUAL(0, errors("-1; 2 * 3; [1]", 3));
+        BOOST_CHECK_EQUAL(1, errors("-1; -(-1); 5", 3));
+        BOOST_CHECK_EQUAL(0, errors(repeat("1 * 2 + ", nesting) + "1", 4));
+        BOOST_CHECK_EQUAL(0, errors(repeat("-", nesting) + "1", 0));
+    }
+
+    BOOST_AUTO_TEST_CASE(testNestingLimitInDeferredBodies) {
+        constexpr std::size_t nesting = 3000;
+        const auto input = "let f = " + repeat("fn() { ", nesting) + "1" + repeat(" }", nesting);
+        auto parser = Parser(Lexer(input), ParserOptions{.lazyFunctionBodies = true});
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+        checkParserErrors(parser);
+        // each body is parsed on the way down, counting from where its function is
+        auto function = functionAt(*program, 0);
+        std::size_t levels = 0;
+        while (true) {
+            const auto &statements = function->body().value()->statements.value();
+            if (!function->bodyErrors().empty()) {
+                break;
+            }
+            BOOST_REQUIRE_EQUAL(1, statements.size());
+            const auto statement = dynamic_cast<ExpressionStatement *>(statements[0].value());
+            function = dynamic_cast<const FunctionLiteral *>(statement->expression.value());
+            BOOST_REQUIRE(function != nullptr);
+            levels++;
+        }
+        BOOST_REQUIRE_LT(levels, DEFAULT_MAX_DEPTH);
+        BOOST_REQUIRE_EQUAL(1, function->bodyErrors().size());
+        BOOST_REQUIRE_EQUAL("nesting deeper than 1000 levels", function->bodyErrors()[0]);
+        BOOST_REQUIRE(!program->to_string().empty());
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
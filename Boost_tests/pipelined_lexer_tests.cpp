@@ -0,0 +1,68 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "parser.h"
+#include "pipelined_lexer.h"
+#include "spsc_ring.h"
+
+BOOST_AUTO_TEST_SUITE(PipelinedLexer_suite)
+    BOOST_AUTO_TEST_CASE(testRingKeepsOrderAcrossWraparound) {
+        SpscRing<int> ring{3};
+        BOOST_REQUIRE_EQUAL(4, ring.capacity());
+        constexpr int count = 100000;
+        std::jthread producer{[&ring] {
+            for (int i = 0; i < count; i++) {
+                while (!ring.tryPush(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        }};
+        for (int expected = 0; expected < count;) {
+            if (const auto value = ring.tryPop(); value.has_value()) {
+                BOOST_REQUIRE_EQUAL(expected, value.value());
+                expected++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        BOOST_REQUIRE(!ring.tryPop().has_value());
+    }
+
+    BOOST_AUTO_TEST_CASE(testPipelinedLexerMatchesLexer) {
+        std::string source;
+        for (int i = 0; i < 500; i++) {
+            source += "let x = fn(a) { a * " + std::to_string(i) + " }; \"str\" != [1, 2][0];\n";
+        }
+        Lexer lexer{source};
+        PipelinedLexer pipelined{Lexer{source}, 16};
+        while (true) {
+            const auto expected = lexer.nextToken();
+            const auto token = pipelined.nextToken();
+            BOOST_REQUIRE_EQUAL(to_string(expected.tokenType), to_string(token.tokenType));
+            BOOST_REQUIRE_EQUAL(expected.literal, token.literal);
+            if (expected.tokenType == TokenType::EOF_) {
+                break;
+            }
+        }
+        BOOST_REQUIRE(pipelined.nextToken().tokenType == TokenType::EOF_);
+
+        Parser parser{Lexer{source}, ParserOptions{.pipelined = true}};
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+        Parser expectedParser{Lexer{source}};
+        BOOST_REQUIRE_EQUAL(std::unique_ptr<Program>{expectedParser.parseProgram()}->to_string(), program->to_string());
+    }
+
+    BOOST_AUTO_TEST_CASE(testDroppingPipelinedLexerStopsProducer) {
+        std::string source;
+        for (int i = 0; i < 10000; i++) {
+            source += "a + b; ";
+        }
+        PipelinedLexer pipelined{Lexer{source}, 8};
+        BOOST_REQUIRE(pipelined.nextToken().tokenType == TokenType::IDENT);
+        // the producer is now stuck on a full ring, and the destructor must still return
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
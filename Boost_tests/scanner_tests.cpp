@@ -0,0 +1,58 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <string>
+
+#include "scanner.h"
+
+std::string randomSource(const std::size_t size, const unsigned seed) {
+    // skewed towards long runs so the vector loops get exercised, not only the tails
+    const std::string alphabet = "     \t\r\nabcxyzABCXYZ____0123456789\"\"+-(){};@\x80\xff";
+    std::mt19937 random{seed};
+    std::uniform_int_distribution<std::size_t> pick{0, alphabet.size() - 1};
+    std::uniform_int_distribution<std::size_t> run{1, 40};
+    std::string source;
+    while (source.size() < size) {
+        source.append(run(random), alphabet[pick(random)]);
+    }
+    source.resize(size);
+    return source;
+}
+
+BOOST_AUTO_TEST_SUITE(Scanner_suite)
+    BOOST_AUTO_TEST_CASE(testKernelsAgreeWithScalar) {
+        const auto &scalar = Scanner::kernels(Scanner::ScanLevel::SCALAR);
+        for (const auto level: {Scanner::ScanLevel::SSE2, Scanner::ScanLevel::AVX2}) {
+            if (!Scanner::supported(level)) {
+                BOOST_TEST_MESSAGE("skipping unsupported " << Scanner::to_string(level));
+                continue;
+            }
+            const auto &kernels = Scanner::kernels(level);
+            BOOST_REQUIRE(kernels.level == level);
+            for (unsigned seed = 0; seed < 8; seed++) {
+                const auto source = randomSource(700, seed);
+                const std::string_view input = source;
+                for (std::size_t from = 0; from <= input.size(); from++) {
+                    BOOST_REQUIRE_EQUAL(scalar.skipWhitespace(input, from), kernels.skipWhitespace(input, from));
+                    BOOST_REQUIRE_EQUAL(scalar.skipIdentifier(input, from), kernels.skipIdentifier(input, from));
+                    BOOST_REQUIRE_EQUAL(scalar.skipDigits(input, from), kernels.skipDigits(input, from));
+                    BOOST_REQUIRE_EQUAL(scalar.findStringEnd(input, from), kernels.findStringEnd(input, from));
+                    BOOST_REQUIRE_EQUAL(scalar.findBlockSyntax(input, from), kernels.findBlockSyntax(input, from));
+                }
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testRunsEndAtTheEndOfInput) {
+        const std::string source(100, ' ');
+        const auto &kernels = Scanner::kernels();
+        BOOST_REQUIRE_EQUAL(100, kernels.skipWhitespace(source, 0));
+        BOOST_REQUIRE_EQUAL(100, kernels.findStringEnd(source, 3));
+        BOOST_REQUIRE_EQUAL(3, kernels.skipIdentifier(source, 3));
+        const std::string string_with_zero = std::string(40, 'a') + ZERO + "\"";
+        BOOST_REQUIRE_EQUAL(40, kernels.findStringEnd(string_with_zero, 0));
+        BOOST_REQUIRE_EQUAL(40, kernels.findBlockSyntax(string_with_zero, 0));
+        BOOST_REQUIRE_EQUAL(100, kernels.findBlockSyntax(source, 0));
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "parser.h"
+#include "stream_lexer.h"
+
+namespace {
+    const std::string SOURCE = "let five = 5;\n"
+            "let add = fn(x, y) { x + y; };\n"
+            "let result = add(five, 10);\n"
+            "!-/*5; 5 < 10 > 5; 10 == 10; 10 != 9;\n"
+            "\"foo bar\" \"\" \"a string literal longer than any of the small chunks\";\n"
+            "[1, 2];{\"foo\": \"bar\"} a_very_long_identifier_that_never_fits_in_one_chunk @ 1234567890";
+
+    std::vector<Token> lexAll(TokenSource &source) {
+        std::vector<Token> tokens;
+        while (true) {
+            tokens.push_back(source.nextToken());
+            if (tokens.back().tokenType == TokenType::EOF_) {
+                return tokens;
+            }
+        }
+    }
+
+    void requireSameTokens(const std::string &input, const std::size_t chunkSize) {
+        Lexer lexer{input};
+        const auto expected = lexAll(lexer);
+        std::istringstream stream{input};
+        StreamLexer streamLexer{stream, chunkSize};
+        const auto tokens = lexAll(streamLexer);
+        BOOST_REQUIRE_EQUAL(expected.size(), tokens.size());
+        for (std::size_t i = 0; i < tokens.size(); i++) {
+            BOOST_REQUIRE_EQUAL(to_string(expected[i].tokenType), to_string(tokens[i].tokenType));
+            BOOST_REQUIRE_EQUAL(expected[i].literal, tokens[i].literal);
+            BOOST_REQUIRE_EQUAL(expected[i].value, tokens[i].value);
+            BOOST_REQUIRE_EQUAL(expected[i].inRange, tokens[i].inRange);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(StreamLexer_suite)
+    BOOST_AUTO_TEST_CASE(testChunkBoundaries) {
+        for (std::size_t chunkSize = 1; chunkSize <= 40; chunkSize++) {
+            requireSameTokens(SOURCE, chunkSize);
+        }
+        requireSameTokens(SOURCE, DEFAULT_STREAM_CHUNK_SIZE);
+    }
+
+    BOOST_AUTO_TEST_CASE(testUnterminatedStringAndZero) {
+        for (std::size_t chunkSize = 1; chunkSize <= 8; chunkSize++) {
+            requireSameTokens("let s = \"never closed", chunkSize);
+            requireSameTokens(std::string{"\"a\0b\" c; d"} + '\0' + "ignored", chunkSize);
+            requireSameTokens(std::string{"x = \"st"} + '\0' + "ring\" y", chunkSize);
+            requireSameTokens("   ", chunkSize);
+            requireSameTokens("", chunkSize);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testMinifiedInputStaysBounded) {
+        std::string input = "let xs=[";
+        for (int i = 0; i < 100000; i++) {
+            input += std::to_string(i) + ",";
+        }
+        input += "0];f(xs[1],{\"k\":[xs]});";
+        for (const std::size_t chunkSize: {16, 256}) {
+            requireSameTokens(input, chunkSize);
+            std::istringstream stream{input};
+            StreamLexer streamLexer{stream, chunkSize};
+            lexAll(streamLexer);
+            // a chunk plus the bit of the previous one after its last delimiter, plus the segment cut from them
+            BOOST_REQUIRE_LE(streamLexer.peakBuffered(), 2 * (chunkSize + 8));
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testParseFromPipe) {
+        int fds[2];
+        BOOST_REQUIRE_EQUAL(0, ::pipe(fds));
+        // Boost.Test assertions aren't thread safe, so the writer only reports back
+        auto written = true;
+        std::jthread writer{[&] {
+            for (std::size_t i = 0; i < SOURCE.size() && written; i += 7) {
+                const auto size = std::min<std::size_t>(7, SOURCE.size() - i);
+                written = ::write(fds[1], SOURCE.data() + i, size) == static_cast<ssize_t>(size);
+            }
+            ::close(fds[1]);
+        }};
+        Parser parser{std::make_unique<StreamLexer>(fds[0], 16)};
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+        writer.join();
+        ::close(fds[0]);
+        BOOST_REQUIRE(written);
+
+        Parser expectedParser{Lexer{SOURCE}};
+        const std::unique_ptr<Program> expected{expectedParser.parseProgram()};
+        BOOST_REQUIRE_EQUAL(expected->to_string(), program->to_string());
+        BOOST_REQUIRE_EQUAL_COLLECTIONS(expectedParser.errors.begin(), expectedParser.errors.end(),
+                                        parser.errors.begin(), parser.errors.end());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,49 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <string>
+
+#include "parser.h"
+#include "symbols.h"
+
+BOOST_AUTO_TEST_SUITE(Symbols_suite)
+    BOOST_AUTO_TEST_CASE(testInternReturnsOneIdPerText) {
+        SymbolTable symbols;
+        const std::string first = "counter";
+        const std::string second = "counter";
+        const auto a = symbols.intern(first);
+        const auto b = symbols.intern(second);
+        const auto c = symbols.intern("other");
+        BOOST_REQUIRE_EQUAL(a.id, b.id);
+        BOOST_REQUIRE_NE(a.id, c.id);
+        // the same copy, compared by address: interned names have no terminating NUL
+        BOOST_REQUIRE(a.name.data() == b.name.data());
+        BOOST_REQUIRE(a.name.data() != first.data());
+        BOOST_REQUIRE_EQUAL("counter", symbols.name(a.id));
+        BOOST_REQUIRE_EQUAL(2, symbols.size());
+        BOOST_REQUIRE_EQUAL(std::string("counter").size() + std::string("other").size(), symbols.bytes());
+        BOOST_REQUIRE(symbols.find("other") == c.id);
+        BOOST_REQUIRE(!symbols.find("missing").has_value());
+    }
+
+    BOOST_AUTO_TEST_CASE(testProgramInternsNames) {
+        Parser parser{Lexer{R"(let x = fn(x, y) { x + y }; let s = "x"; x(s, "x");)"}};
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+        BOOST_REQUIRE(parser.errors.empty());
+        // x, y, s: string literal contents share the table with identifiers
+        BOOST_REQUIRE_EQUAL(3, program->symbols->size());
+        const auto let = dynamic_cast<LetStatement *>(program->statements[0]);
+        const auto function = dynamic_cast<FunctionLiteral *>(let->value.value());
+        const auto call = dynamic_cast<CallExpression *>(
+            dynamic_cast<ExpressionStatement *>(program->statements[2])->expression.value());
+        const auto callee = dynamic_cast<Identifier *>(call->function.value());
+        const auto literal = dynamic_cast<StringLiteral *>(call->arguments->at(1).value());
+        BOOST_REQUIRE_EQUAL(let->name.symbol, function->parameters->at(0)->symbol);
+        BOOST_REQUIRE_EQUAL(let->name.symbol, callee->symbol);
+        BOOST_REQUIRE_EQUAL(let->name.symbol, literal->symbol);
+        BOOST_REQUIRE(let->name.value.data() == callee->value.data());
+        BOOST_REQUIRE_NE(let->name.symbol, function->parameters->at(1)->symbol);
+        BOOST_REQUIRE_EQUAL("x", program->symbols->name(callee->symbol));
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
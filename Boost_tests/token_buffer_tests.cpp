@@ -0,0 +1,160 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <sys/mman.h>
+
+#include "parser.h"
+#include "token_buffer.h"
+
+namespace {
+    const std::string SOURCE = R"(let add = fn(x, y) { x + y; };
+let s = "";
+if (add(1, 2) != 3) { return [1, 2][0]; } else { {"a": !true} }
+@ 10 <= 5;)";
+}
+
+BOOST_AUTO_TEST_SUITE(TokenBuffer_suite)
+    BOOST_AUTO_TEST_CASE(testBufferMatchesLexer) {
+        const auto buffer = TokenBuffer::lex(Lexer{SOURCE});
+        BOOST_REQUIRE_EQUAL(buffer.types.size(), buffer.offsets.size());
+        BOOST_REQUIRE_EQUAL(buffer.types.size(), buffer.lengths.size());
+        Lexer lexer{SOURCE};
+        std::size_t index = 0;
+        for (auto expected = lexer.nextToken(); ; expected = lexer.nextToken(), index++) {
+            const auto token = buffer.token(index);
+            BOOST_REQUIRE_EQUAL(to_string(expected.tokenType), to_string(token.tokenType));
+            BOOST_REQUIRE_EQUAL(expected.literal, token.literal);
+            if (expected.tokenType == TokenType::EOF_) {
+                break;
+            }
+        }
+        BOOST_REQUIRE_EQUAL(index + 1, buffer.size());
+        BOOST_REQUIRE(buffer.token(buffer.size() + 10).tokenType == TokenType::EOF_);
+    }
+
+    BOOST_AUTO_TEST_CASE(testBufferKeepsIntegerValues) {
+        // lexed in two segments, appended one after the other
+        const auto buffer = TokenBuffer::lexParallel(Lexer{"1 99999999999999999999999 3 99999999999999999999999 5"}, 2,
+                                                     1);
+        const auto expected = {
+            std::tuple{1L, true},
+            std::tuple{0L, false},
+            std::tuple{3L, true},
+            std::tuple{0L, false},
+            std::tuple{5L, true},
+            std::tuple{0L, true},
+        };
+        std::size_t index = 0;
+        for (const auto &[value, inRange]: expected) {
+            const auto token = buffer.token(index++);
+            BOOST_REQUIRE_EQUAL(value, token.value);
+            BOOST_REQUIRE_EQUAL(inRange, token.inRange);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testCursorLooksAhead) {
+        TokenCursor cursor{TokenBuffer::lex(Lexer{"let x = 5;"})};
+        BOOST_REQUIRE(cursor.peek(3).tokenType == TokenType::INT);
+        BOOST_REQUIRE(cursor.nextToken().tokenType == TokenType::LET);
+        BOOST_REQUIRE_EQUAL("x", cursor.peek(0).literal);
+        BOOST_REQUIRE(cursor.peek(100).tokenType == TokenType::EOF_);
+    }
+
+    BOOST_AUTO_TEST_CASE(testParserWalksBuffer) {
+        const auto valid = SOURCE.substr(0, SOURCE.find('@'));
+        Parser onDemand{Lexer{valid}};
+        const std::unique_ptr<Program> expected{onDemand.parseProgram()};
+        BOOST_REQUIRE(onDemand.errors.empty());
+
+        Parser preLexed{Lexer{valid}, ParserOptions{.preLex = true}};
+        const std::unique_ptr<Program> program{preLexed.parseProgram()};
+        BOOST_REQUIRE(preLexed.errors.empty());
+        BOOST_REQUIRE_EQUAL(expected->to_string(), program->to_string());
+
+        Parser fromBuffer{TokenBuffer::lex(Lexer{valid})};
+        const std::unique_ptr<Program> buffered{fromBuffer.parseProgram()};
+        BOOST_REQUIRE_EQUAL(expected->to_string(), buffered->to_string());
+    }
+
+    BOOST_AUTO_TEST_CASE(testParallelLexMatchesLex) {
+        std::string strings;
+        for (int i = 0; i < 50; i++) {
+            strings += "[\"a long \\\" string, with { and spaces\", " + std::to_string(i) + "] ";
+        }
+        const auto inputs = {
+            SOURCE,
+            strings,
+            std::string{"let s = \"unterminated string spanning every slice"},
+            std::string{"\"in \0 string\" still lexed; "} + '\0' + " after the end",
+            std::string{"a b c d e f g h i j"},
+            std::string{""},
+        };
+        for (const auto &input: inputs) {
+            const auto expected = TokenBuffer::lex(Lexer{input});
+            for (std::size_t threads = 1; threads <= 9; threads++) {
+                Lexer lexer{input};
+                const auto parallel = TokenBuffer::lexParallel(lexer, threads, 1);
+                BOOST_REQUIRE(expected.types == parallel.types);
+                BOOST_REQUIRE(expected.offsets == parallel.offsets);
+                BOOST_REQUIRE(expected.lengths == parallel.lengths);
+                BOOST_REQUIRE_EQUAL(lexer.source(), parallel.source);
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(testParallelLexSplitsMinifiedInput) {
+        std::string input = "[";
+        for (int i = 0; i < 10000; i++) {
+            input += "[1,2,3],{\"a\":f(x)},";
+        }
+        input += "[]]";
+        const auto cuts = TokenBuffer::segments(input, 4);
+        BOOST_REQUIRE_EQUAL(5, cuts.size());
+        BOOST_REQUIRE_EQUAL(input.size(), cuts.back());
+        for (std::size_t k = 0; k < 4; k++) {
+            // every thread gets about a quarter, none of them nothing
+            BOOST_REQUIRE_GT(cuts[k + 1], cuts[k]);
+            BOOST_REQUIRE_LT(cuts[k + 1] - cuts[k], input.size() / 3);
+        }
+        const auto parallel = TokenBuffer::lexParallel(Lexer{input}, 4, 1);
+        const auto expected = TokenBuffer::lex(Lexer{input});
+        BOOST_REQUIRE(expected.types == parallel.types);
+        BOOST_REQUIRE(expected.offsets == parallel.offsets);
+        BOOST_REQUIRE(expected.lengths == parallel.lengths);
+    }
+
+    BOOST_AUTO_TEST_CASE(testParserOverParallelLex) {
+        Parser parser{TokenBuffer::lexParallel(Lexer{SOURCE.substr(0, SOURCE.find('@'))}, 4, 16)};
+        const std::unique_ptr<Program> program{parser.parseProgram()};
+        BOOST_REQUIRE(parser.errors.empty());
+        Parser expected{Lexer{SOURCE.substr(0, SOURCE.find('@'))}};
+        BOOST_REQUIRE_EQUAL(std::unique_ptr<Program>{expected.parseProgram()}->to_string(), program->to_string());
+    }
+
+    BOOST_AUTO_TEST_CASE(testInputTooLongForBuffer) {
+        // reserved but never touched past the first page: ZERO ends the input for the Lexer right after the code
+        const auto size = MAX_TOKEN_BUFFER_INPUT + 2;
+        const auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                                 -1, 0);
+        BOOST_REQUIRE(memory != MAP_FAILED);
+        const std::string code = "let x = 1;";
+        std::memcpy(memory, code.data(), code.size());
+        const std::string_view text{static_cast<const char *>(memory), size};
+
+        BOOST_CHECK_THROW(static_cast<void>(TokenBuffer::lex(Lexer{text})), std::length_error);
+        BOOST_CHECK_THROW(static_cast<void>(TokenBuffer::lexParallel(Lexer{text}, 4)), std::length_error);
+        // preLex falls back to lexing on demand
+        for (const std::size_t threads: {1, 4}) {
+            Parser parser{Lexer{text}, ParserOptions{.preLex = true, .lexThreads = threads}};
+            const std::unique_ptr<Program> program{parser.parseProgram()};
+            BOOST_CHECK(parser.errors.empty());
+            BOOST_CHECK_EQUAL(code, program->to_string());
+        }
+        munmap(memory, size);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ArenaUtil {
+    std::byte *align(std::byte *p, const std::size_t alignment) {
+        const auto address = reinterpret_cast<std::uintptr_t>(p);
+        const auto aligned = (address + alignment - 1) & ~(alignment - 1);
+        return p + (aligned - address);
+    }
+}
+
+ParseArena::ParseArena(const std::size_t chunkSize) : chunkSize{chunkSize} {
+}
+
+ParseArena::~ParseArena() {
+    runFinalizers();
+}
+
+void *ParseArena::allocate(const std::size_t size, const std::size_t alignment) {
+    auto start = current == nullptr ? nullptr : ArenaUtil::align(current, alignment);
+    if (start == nullptr || start + size > end) {
+        addChunk(size + alignment);
+        start = ArenaUtil::align(current, alignment);
+    }
+    current = start + size;
+    allocated += size;
+    return start;
+}
+
+void ParseArena::reset(const std::size_t retainBytes) {
+    runFinalizers();
+    std::size_t kept = 0;
+    std::size_t count = 0;
+    while (count < chunks.size() && chunks[count].size <= retainBytes - kept) {
+        kept += chunks[count++].size;
+    }
+    chunks.erase(chunks.begin() + static_cast<std::ptrdiff_t>(count), chunks.end());
+    active = 0;
+    current = chunks.empty() ? nullptr : chunks.front().memory.get();
+    end = chunks.empty() ? nullptr : current + chunks.front().size;
+    allocated = 0;
+    reserved = kept;
+}
+
+std::size_t ParseArena::bytesAllocated() const {
+    return allocated;
+}
+
+std::size_t ParseArena::bytesReserved() const {
+    return reserved;
+}
+
+void ParseArena::addChunk(const std::size_t minimumSize) {
+    // a chunk kept by reset() that's too small for this allocation stays unused until the next reset()
+    while (current != nullptr && ++active < chunks.size()) {
+        if (chunks[active].size >= minimumSize) {
+            current = chunks[active].memory.get();
+            end = current + chunks[active].size;
+            return;
+        }
+    }
+    const auto size = std::max(chunkSize, minimumSize);
+    chunks.push_back(Chunk{std::make_unique_for_overwrite<std::byte[]>(size), size});
+    active = chunks.size() - 1;
+    current = chunks.back().memory.get();
+    end = current + size;
+    reserved += size;
+}
+
+void ParseArena::runFinalizers() {
+    while (finalizers != nullptr) {
+        const auto finalizer = finalizers;
+        finalizers = finalizer->next;
+        finalizer->destroy(finalizer->object);
+    }
+}
+
+void ParseArena::registerFinalizer(void *object, void (*destroy)(void *)) {
+    const auto memory = allocate(sizeof(Finalizer), alignof(Finalizer));
+    finalizers = new(memory) Finalizer{finalizers, object, destroy};
+}
@@ -0,0 +1,75 @@
+#ifndef PITAYA_ARENA_H
+#define PITAYA_ARENA_H
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+static constexpr std::size_t DEFAULT_ARENA_CHUNK_SIZE = 64 * 1024;
+
+// Bump allocator backing every token and AST node produced by a single parse.
+// Objects are carved out of contiguous chunks and released all together when the arena is destroyed;
+// destructors of non-trivially destructible objects run in reverse allocation order.
+struct ParseArena {
+    explicit ParseArena(std::size_t chunkSize = DEFAULT_ARENA_CHUNK_SIZE);
+
+    ~ParseArena();
+
+    ParseArena(const ParseArena &) = delete;
+
+    ParseArena &operator=(const ParseArena &) = delete;
+
+    void *allocate(std::size_t size, std::size_t alignment);
+
+    template<typename T, typename... Args>
+    T *make(Args &&... args) {
+        void *memory = allocate(sizeof(T), alignof(T));
+        T *object = new(memory) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            registerFinalizer(object, [](void *o) { static_cast<T *>(o)->~T(); });
+        }
+        return object;
+    }
+
+    // Destroys every object, like dropping the arena, but keeps the chunks for the allocations that follow: the first
+    // ones, up to retainBytes of them, are kept and the rest freed
+    void reset(std::size_t retainBytes = std::numeric_limits<std::size_t>::max());
+
+    [[nodiscard]] std::size_t bytesAllocated() const;
+
+    [[nodiscard]] std::size_t bytesReserved() const;
+
+private:
+    struct Chunk {
+        std::unique_ptr<std::byte[]> memory;
+        std::size_t size;
+    };
+
+    struct Finalizer {
+        Finalizer *next;
+        void *object;
+        void (*destroy)(void *);
+    };
+
+    const std::size_t chunkSize;
+    std::vector<Chunk> chunks;
+    // the chunk current points into; the ones after it are free, left over from before a reset()
+    std::size_t active = 0;
+    std::byte *current = nullptr;
+    std::byte *end = nullptr;
+    std::size_t allocated = 0;
+    std::size_t reserved = 0;
+    Finalizer *finalizers = nullptr;
+
+    void addChunk(std::size_t minimumSize);
+
+    void runFinalizers();
+
+    void registerFinalizer(void *object, void (*destroy)(void *));
+};
+
+#endif //PITAYA_ARENA_H
@@ -4,26 +4,83 @@
 //
 #include "ast.h"
 //
+#include <atomic>
 #include <sstream>
 #include <utility>
-#include <boost/algorithm/string/join.hpp>
+#include <boost/container_hash/hash.hpp>
 
 namespace ASTUtil {
-    std::string to_string(std::optional<Statement *> op) {
-        return op.transform([](const Statement *st) {
-            return st->to_string();
-        }).value_or("");
-    }
-
-    std::string join_to_string(OPT_STATEMENT_LIST l, const std::string &separator) {
-        return l.transform([separator](const std::vector<std::optional<Statement *> > &ll) {
-            std::vector<std::string> sts{};
-            sts.reserve(ll.size());
-            for (const auto statement: ll) {
-                sts.push_back(to_string(statement));
+    template<typename T>
+    void print(std::ostream &out, const std::optional<T *> op) {
+        if (op.has_value()) {
+            op.value()->print(out);
+        }
+    }
+
+    template<typename T>
+    std::size_t hash(const std::optional<T *> op) {
+        return op.has_value() ? op.value()->hash() : 0;
+    }
+
+    std::size_t hash(const OPT_STATEMENT_LIST &l) {
+        if (!l.has_value()) {
+            return 0;
+        }
+        auto seed = l->size();
+        for (const auto statement: l.value()) {
+            boost::hash_combine(seed, hash(statement));
+        }
+        return seed;
+    }
+
+    int compare(const std::string_view a, const std::string_view b) {
+        const auto c = a.compare(b);
+        return (c > 0) - (c < 0);
+    }
+
+    template<typename T>
+    int compare(const T a, const T b) {
+        return (a > b) - (a < b);
+    }
+
+    template<typename T>
+    int compare(const std::optional<T *> a, const std::optional<T *> b) {
+        if (a.has_value() != b.has_value()) {
+            return a.has_value() ? 1 : -1;
+        }
+        return a.has_value() ? a.value()->compare(*b.value()) : 0;
+    }
+
+    int compare(const OPT_STATEMENT_LIST &a, const OPT_STATEMENT_LIST &b) {
+        if (a.has_value() != b.has_value()) {
+            return a.has_value() ? 1 : -1;
+        }
+        if (!a.has_value()) {
+            return 0;
+        }
+        if (const auto c = compare(a->size(), b->size()); c != 0) {
+            return c;
+        }
+        for (std::size_t i = 0; i < a->size(); i++) {
+            if (const auto c = compare((*a)[i], (*b)[i]); c != 0) {
+                return c;
             }
-            return boost::algorithm::join(sts, separator);
-        }).value_or("");
+        }
+        return 0;
+    }
+
+    void join(std::ostream &out, const OPT_STATEMENT_LIST &l, const std::string_view separator) {
+        if (!l.has_value()) {
+            return;
+        }
+        auto first = true;
+        for (const auto statement: l.value()) {
+            if (!first) {
+                out << separator;
+            }
+            first = false;
+            print(out, statement);
+        }
     }
 }
 
@@ -31,53 +88,171 @@ namespace ASTUtil {
 Statement::Statement(Token token) : token{std::move(token)} {
 }
 
-std::string Statement::tokenLiteral() const {
+std::string_view Statement::tokenLiteral() const {
     return token.literal;
 }
 
+void Statement::print(std::ostream &out) const {
+    out << "Statement";
+}
+
 std::string Statement::to_string() const {
-    return "Statement";
+    std::stringstream ss;
+    print(ss);
+    return ss.str();
+}
+
+NodeKind Statement::kind() const {
+    return NodeKind::STATEMENT;
+}
+
+std::size_t Statement::hash() const {
+    // atomic_ref: a Program may be shared between threads, which may all fill the cache at the same time
+    const std::atomic_ref cache{cachedHash};
+    if (const auto cached = cache.load(std::memory_order_relaxed); cached != 0) {
+        return cached;
+    }
+    auto seed = static_cast<std::size_t>(kind());
+    boost::hash_combine(seed, hashFields());
+    if (seed == 0) {
+        seed = 1;
+    }
+    cache.store(seed, std::memory_order_relaxed);
+    return seed;
+}
+
+int Statement::compare(const Statement &s) const {
+    if (this == &s) {
+        return 0;
+    }
+    if (const auto c = ASTUtil::compare(kind(), s.kind()); c != 0) {
+        return c;
+    }
+    if (const auto c = ASTUtil::compare(hash(), s.hash()); c != 0) {
+        return c;
+    }
+    return compareFields(s);
+}
+
+bool Statement::operator==(const Statement &s) const {
+    return compare(s) == 0;
 }
 
 bool Statement::operator<(const Statement &s) const {
-    return to_string() < s.to_string();
+    return compare(s) < 0;
 }
 
-Program::Program(const std::vector<Statement *> &statements) : statements{statements} {
+std::size_t Statement::hashFields() const {
+    return 0;
 }
 
-std::string Program::to_string() const {
-    std::stringstream ss;
+int Statement::compareFields(const Statement &) const {
+    return 0;
+}
+
+std::size_t StatementHash::operator()(const Statement *statement) const {
+    return statement->hash();
+}
+
+bool StatementEqual::operator()(const Statement *a, const Statement *b) const {
+    return *a == *b;
+}
+
+bool StatementLess::operator()(const Statement *a, const Statement *b) const {
+    return *a < *b;
+}
+
+Program::Program(std::vector<Statement *> statements,
+                 std::shared_ptr<ParseArena> arena,
+                 std::shared_ptr<const void> source,
+                 std::shared_ptr<const SymbolTable> symbols) : statements{std::move(statements)}, arena{std::move(arena)},
+                                                               source{std::move(source)}, symbols{std::move(symbols)} {
+}
+
+void Program::print(std::ostream &out) const {
     for (const auto statement: statements) {
-        ss << statement->to_string();
+        statement->print(out);
     }
+}
+
+std::string Program::to_string() const {
+    std::stringstream ss;
+    print(ss);
     return ss.str();
 }
 
-StringValue::StringValue(const Token &token, std::string value) : Statement(token), value{std::move(value)} {
+StringValue::StringValue(const Token &token, const Symbol symbol) : Statement(token), symbol{symbol.id},
+                                                                     value{symbol.name} {
+}
+
+std::size_t StringValue::hashFields() const {
+    return std::hash<std::string_view>{}(value);
+}
+
+int StringValue::compareFields(const Statement &s) const {
+    const auto &other = static_cast<const StringValue &>(s);
+    // interned in the same table: same storage means same symbol, so equal names never reach the string compare
+    if (value.data() == other.value.data()) {
+        return ASTUtil::compare(value.size(), other.value.size());
+    }
+    return ASTUtil::compare(value, other.value);
+}
+
+void StringValue::print(std::ostream &out) const {
+    out << value;
 }
 
-std::string StringValue::to_string() const {
-    return value;
+Identifier::Identifier(const Token &token, const Symbol symbol) : StringValue(token, symbol) {
 }
 
-Identifier::Identifier(const Token &token, const std::string &value) : StringValue(token, value) {
+NodeKind Identifier::kind() const {
+    return NodeKind::IDENTIFIER;
 }
 
 LetStatement::LetStatement(const Token &token, Identifier name, std::optional<Statement *> value) : Statement(token),
     name{std::move(name)}, value{value} {
 }
 
-std::string LetStatement::to_string() const {
-    std::stringstream ss;
-    ss << tokenLiteral() << " " << name.to_string() << " = " << ASTUtil::to_string(value) << ";";
-    return ss.str();
+NodeKind LetStatement::kind() const {
+    return NodeKind::LET_STATEMENT;
+}
+
+std::size_t LetStatement::hashFields() const {
+    auto seed = name.hash();
+    boost::hash_combine(seed, ASTUtil::hash(value));
+    return seed;
+}
+
+int LetStatement::compareFields(const Statement &s) const {
+    const auto &other = static_cast<const LetStatement &>(s);
+    if (const auto c = name.compare(other.name); c != 0) {
+        return c;
+    }
+    return ASTUtil::compare(value, other.value);
+}
+
+void LetStatement::print(std::ostream &out) const {
+    out << tokenLiteral() << " ";
+    name.print(out);
+    out << " = ";
+    ASTUtil::print(out, value);
+    out << ";";
 }
 
 template<typename T>
 LiteralExpression<T>::LiteralExpression(const Token &token, T value) : Statement(token), value{value} {
 }
 
+template<typename T>
+std::size_t LiteralExpression<T>::hashFields() const {
+    return std::hash<T>{}(value);
+}
+
+template<typename T>
+int LiteralExpression<T>::compareFields(const Statement &s) const {
+    return ASTUtil::compare(value, static_cast<const LiteralExpression &>(s).value);
+}
+
 // template<typename T>
 // std::string LiteralExpression<long>::to_string() const {
 // return Statement::to_string();
@@ -86,18 +261,34 @@ LiteralExpression<T>::LiteralExpression(const Token &token, T value) : Statement
 IntegerLiteral::IntegerLiteral(const Token &token, const long value) : LiteralExpression(token, value) {
 }
 
-std::string IntegerLiteral::to_string() const {
-    return std::to_string(value);
+NodeKind IntegerLiteral::kind() const {
+    return NodeKind::INTEGER_LITERAL;
+}
+
+void IntegerLiteral::print(std::ostream &out) const {
+    out << value;
 }
 
 ReturnStatement::ReturnStatement(const Token &token, const std::optional<Statement *> &returnValue) : Statement(token),
     returnValue{returnValue} {
 }
 
-std::string ReturnStatement::to_string() const {
-    std::stringstream ss;
-    ss << tokenLiteral() << " " << ASTUtil::to_string(returnValue) << ";";
-    return ss.str();
+NodeKind ReturnStatement::kind() const {
+    return NodeKind::RETURN_STATEMENT;
+}
+
+std::size_t ReturnStatement::hashFields() const {
+    return ASTUtil::hash(returnValue);
+}
+
+int ReturnStatement::compareFields(const Statement &s) const {
+    return ASTUtil::compare(returnValue, static_cast<const ReturnStatement &>(s).returnValue);
+}
+
+void ReturnStatement::print(std::ostream &out) const {
+    out << tokenLiteral() << " ";
+    ASTUtil::print(out, returnValue);
+    out << ";";
 }
 
 ExpressionStatement::ExpressionStatement(const Token &token,
@@ -105,68 +296,156 @@ ExpressionStatement::ExpressionStatement(const Token &token,
     expression{expression} {
 }
 
-std::string ExpressionStatement::to_string() const {
-    return ASTUtil::to_string(expression);
+NodeKind ExpressionStatement::kind() const {
+    return NodeKind::EXPRESSION_STATEMENT;
+}
+
+std::size_t ExpressionStatement::hashFields() const {
+    return ASTUtil::hash(expression);
+}
+
+int ExpressionStatement::compareFields(const Statement &s) const {
+    return ASTUtil::compare(expression, static_cast<const ExpressionStatement &>(s).expression);
+}
+
+void ExpressionStatement::print(std::ostream &out) const {
+    ASTUtil::print(out, expression);
 }
 
 BooleanLiteral::BooleanLiteral(const Token &token, const bool value) : LiteralExpression(token, value) {
 }
 
-std::string BooleanLiteral::to_string() const {
-    return value ? "true" : "false";
+NodeKind BooleanLiteral::kind() const {
+    return NodeKind::BOOLEAN_LITERAL;
+}
+
+void BooleanLiteral::print(std::ostream &out) const {
+    out << (value ? "true" : "false");
 }
 
 PrefixExpression::PrefixExpression(const Token &token,
-                                   std::string op,
+                                   const std::string_view op,
                                    const std::optional<Statement *> right) : Statement(token),
-                                                                             op{std::move(op)},
+                                                                             op{op},
                                                                              right{right} {
 }
 
-std::string PrefixExpression::to_string() const {
-    std::stringstream ss;
-    ss << "(" << op << ASTUtil::to_string(right) << ")";
-    return ss.str();
+NodeKind PrefixExpression::kind() const {
+    return NodeKind::PREFIX_EXPRESSION;
+}
+
+std::size_t PrefixExpression::hashFields() const {
+    auto seed = std::hash<std::string_view>{}(op);
+    boost::hash_combine(seed, ASTUtil::hash(right));
+    return seed;
+}
+
+int PrefixExpression::compareFields(const Statement &s) const {
+    const auto &other = static_cast<const PrefixExpression &>(s);
+    if (const auto c = ASTUtil::compare(op, other.op); c != 0) {
+        return c;
+    }
+    return ASTUtil::compare(right, other.right);
+}
+
+void PrefixExpression::print(std::ostream &out) const {
+    out << "(" << op;
+    ASTUtil::print(out, right);
+    out << ")";
 }
 
 InfixExpression::InfixExpression(const Token &token,
                                  const std::optional<Statement *> left,
-                                 std::string op,
+                                 const std::string_view op,
                                  const std::optional<Statement *> right) : Statement(token),
                                                                            left{left},
-                                                                           op{std::move(op)},
+                                                                           op{op},
                                                                            right{right} {
 }
 
-std::string InfixExpression::to_string() const {
-    std::stringstream ss;
-    ss << "(" << ASTUtil::to_string(left) << " " << op << " " << ASTUtil::to_string(right) << ")";
-    return ss.str();
+NodeKind InfixExpression::kind() const {
+    return NodeKind::INFIX_EXPRESSION;
+}
+
+std::size_t InfixExpression::hashFields() const {
+    auto seed = ASTUtil::hash(left);
+    boost::hash_combine(seed, std::hash<std::string_view>{}(op));
+    boost::hash_combine(seed, ASTUtil::hash(right));
+    return seed;
+}
+
+int InfixExpression::compareFields(const Statement &s) const {
+    const auto &other = static_cast<const InfixExpression &>(s);
+    if (const auto c = ASTUtil::compare(op, other.op); c != 0) {
+        return c;
+    }
+    if (const auto c = ASTUtil::compare(left, other.left); c != 0) {
+        return c;
+    }
+    return ASTUtil::compare(right, other.right);
+}
+
+void InfixExpression::print(std::ostream &out) const {
+    out << "(";
+    ASTUtil::print(out, left);
+    out << " " << op << " ";
+    ASTUtil::print(out, right);
+    out << ")";
 }
 
 CallExpression::CallExpression(const Token &token,
                                const std::optional<Statement *> function,
-                               const OPT_STATEMENT_LIST &
-                               arguments) : Statement(token),
-                                            function{function},
-                                            arguments{arguments} {
+                               OPT_STATEMENT_LIST arguments) : Statement(token),
+                                                               function{function},
+                                                               arguments{std::move(arguments)} {
 }
 
-std::string CallExpression::to_string() const {
-    std::stringstream ss;
-    ss << ASTUtil::to_string(function) << "(" << ASTUtil::join_to_string(arguments, ", ") << ")";
-    return ss.str();
+NodeKind CallExpression::kind() const {
+    return NodeKind::CALL_EXPRESSION;
+}
+
+std::size_t CallExpression::hashFields() const {
+    auto seed = ASTUtil::hash(function);
+    boost::hash_combine(seed, ASTUtil::hash(arguments));
+    return seed;
+}
+
+int CallExpression::compareFields(const Statement &s) const {
+    const auto &other = static_cast<const CallExpression &>(s);
+    if (const auto c = ASTUtil::compare(function, other.function); c != 0) {
+        return c;
+    }
+    return ASTUtil::compare(arguments, other.arguments);
+}
+
+void CallExpression::print(std::ostream &out) const {
+    ASTUtil::print(out, function);
+    out << "(";
+    ASTUtil::join(out, arguments, ", ");
+    out << ")";
 }
 
 ArrayLiteral::ArrayLiteral(const Token &token,
-                           const OPT_STATEMENT_LIST &elements) : Statement(token),
-                                                                 elements{elements} {
+                           OPT_STATEMENT_LIST elements) : Statement(token),
+                                                          elements{std::move(elements)} {
 }
 
-std::string ArrayLiteral::to_string() const {
-    std::stringstream ss;
-    ss << "[" << ASTUtil::join_to_string(elements, ", ") << "]";
-    return ss.str();
+NodeKind ArrayLiteral::kind() const {
+    return NodeKind::ARRAY_LITERAL;
+}
+
+std::size_t ArrayLiteral::hashFields() const {
+    return ASTUtil::hash(elements);
+}
+
+int ArrayLiteral::compareFields(const Statement &s) const {
+    return ASTUtil::compare(elements, static_cast<const ArrayLiteral &>(s).elements);
+}
+
+void ArrayLiteral::print(std::ostream &out) const {
+    out << "[";
+    ASTUtil::join(out, elements, ", ");
+    out << "]";
 }
 
 IndexExpression::IndexExpression(const Token &token,
@@ -174,18 +453,50 @@ IndexExpression::IndexExpression(const Token &token,
                                  const std::optional<Statement *> index) : Statement(token), left{left}, index{index} {
 }
 
-std::string IndexExpression::to_string() const {
-    std::stringstream ss;
-    ss << "(" << ASTUtil::to_string(left) << "[" << ASTUtil::to_string(index) << "])";
-    return ss.str();
+NodeKind IndexExpression::kind() const {
+    return NodeKind::INDEX_EXPRESSION;
+}
+
+std::size_t IndexExpression::hashFields() const {
+    auto seed = ASTUtil::hash(left);
+    boost::hash_combine(seed, ASTUtil::hash(index));
+    return seed;
+}
+
+int IndexExpression::compareFields(const Statement &s) const {
+    const auto &other = static_cast<const IndexExpression &>(s);
+    if (const auto c = ASTUtil::compare(left, other.left); c != 0) {
+        return c;
+    }
+    return ASTUtil::compare(index, other.index);
+}
+
+void IndexExpression::print(std::ostream &out) const {
+    out << "(";
+    ASTUtil::print(out, left);
+    out << "[";
+    ASTUtil::print(out, index);
+    out << "])";
+}
+
+BlockStatement::BlockStatement(const Token &token, OPT_STATEMENT_LIST statements) : Statement(token),
+    statements{std::move(statements)} {
+}
+
+NodeKind BlockStatement::kind() const {
+    return NodeKind::BLOCK_STATEMENT;
+}
+
+std::size_t BlockStatement::hashFields() const {
+    return ASTUtil::hash(statements);
 }
 
-BlockStatement::BlockStatement(const Token &token, const OPT_STATEMENT_LIST &statements) : Statement(token),
-    statements{statements} {
+int BlockStatement::compareFields(const Statement &s) const {
+    return ASTUtil::compare(statements, static_cast<const BlockStatement &>(s).statements);
 }
 
-std::string BlockStatement::to_string() const {
-    return ASTUtil::join_to_string(statements, "");
+void BlockStatement::print(std::ostream &out) const {
+    ASTUtil::join(out, statements, "");
 }
 
 IfExpression::IfExpression(const Token &token,
@@ -195,25 +506,169 @@ IfExpression::IfExpression(const Token &token,
     consequence{consequence}, alternative{alternative} {
 }
 
-std::string IfExpression::to_string() const {
-    std::stringstream ss;
-    ss << "if " << ASTUtil::to_string(condition) << " " << ASTUtil::to_string(consequence);
+NodeKind IfExpression::kind() const {
+    return NodeKind::IF_EXPRESSION;
+}
+
+std::size_t IfExpression::hashFields() const {
+    auto seed = ASTUtil::hash(condition);
+    boost::hash_combine(seed, ASTUtil::hash(consequence));
+    boost::hash_combine(seed, ASTUtil::hash(alternative));
+    return seed;
+}
+
+int IfExpression::compareFields(const Statement &s) const {
+    const auto &other = static_cast<const IfExpression &>(s);
+    if (const auto c = ASTUtil::compare(condition, other.condition); c != 0) {
+        return c;
+    }
+    if (const auto c = ASTUtil::compare(consequence, other.consequence); c != 0) {
+        return c;
+    }
+    return ASTUtil::compare(alternative, other.alternative);
+}
+
+void IfExpression::print(std::ostream &out) const {
+    out << "if ";
+    ASTUtil::print(out, condition);
+    out << " ";
+    ASTUtil::print(out, consequence);
     if (alternative.has_value()) {
-        ss << " else " << ASTUtil::to_string(alternative);
+        out << " else ";
+        ASTUtil::print(out, alternative);
     }
-    return ss.str();
 }
 
 FunctionLiteral::FunctionLiteral(const Token &token,
-                                 const std::optional<std::vector<Identifier *> > &parameters,
+                                 std::optional<std::vector<Identifier *> > parameters,
                                  const std::optional<BlockStatement *> body) : Statement(token),
-                                                                               parameters{parameters}, body{body},
-                                                                               name{""} {
+                                                                               parameters{std::move(parameters)},
+                                                                               name{""},
+                                                                               parsedBody{body} {
+}
+
+FunctionLiteral::FunctionLiteral(const Token &token,
+                                 std::optional<std::vector<Identifier *> > parameters,
+                                 const DeferredBody *deferred) : Statement(token), parameters{std::move(parameters)},
+                                                                 name{""},
+                                                                 deferredBody{deferred} {
+}
+
+std::optional<BlockStatement *> FunctionLiteral::body() const {
+    if (deferredBody != nullptr) {
+        return std::optional{deferredBody->parse()};
+    }
+    return parsedBody;
+}
+
+bool FunctionLiteral::deferred() const {
+    return deferredBody != nullptr && !deferredBody->parsed();
+}
+
+std::vector<std::string> FunctionLiteral::bodyErrors() const {
+    return deferredBody != nullptr ? deferredBody->errors() : std::vector<std::string>{};
+}
+
+NodeKind FunctionLiteral::kind() const {
+    return NodeKind::FUNCTION_LITERAL;
+}
+
+std::size_t FunctionLiteral::hashFields() const {
+    std::size_t seed = parameters.has_value() ? parameters->size() + 1 : 0;
+    if (parameters.has_value()) {
+        for (const auto parameter: parameters.value()) {
+            boost::hash_combine(seed, parameter->hash());
+        }
+    }
+    boost::hash_combine(seed, ASTUtil::hash(body()));
+    return seed;
+}
+
+int FunctionLiteral::compareFields(const Statement &s) const {
+    const auto &other = static_cast<const FunctionLiteral &>(s);
+    if (parameters.has_value() != other.parameters.has_value()) {
+        return parameters.has_value() ? 1 : -1;
+    }
+    if (parameters.has_value()) {
+        if (const auto c = ASTUtil::compare(parameters->size(), other.parameters->size()); c != 0) {
+            return c;
+        }
+        for (std::size_t i = 0; i < parameters->size(); i++) {
+            if (const auto c = (*parameters)[i]->compare(*(*other.parameters)[i]); c != 0) {
+                return c;
+            }
+        }
+    }
+    return ASTUtil::compare(body(), other.body());
+}
+
+void FunctionLiteral::print(std::ostream &out) const {
+    out << tokenLiteral() << "(";
+    if (parameters.has_value()) {
+        auto first = true;
+        for (const auto parameter: parameters.value()) {
+            if (!first) {
+                out << ", ";
+            }
+            first = false;
+            parameter->print(out);
+        }
+    }
+    out << ") ";
+    ASTUtil::print(out, body());
 }
 
-StringLiteral::StringLiteral(const Token &token, const std::string &value) : StringValue(token, value) {
+StringLiteral::StringLiteral(const Token &token, const Symbol symbol) : StringValue(token, symbol) {
 }
 
-HashLiteral::HashLiteral(const Token &token, const std::map<Statement *, Statement *> &pairs) : Statement(token),
-    pairs{pairs} {
+NodeKind StringLiteral::kind() const {
+    return NodeKind::STRING_LITERAL;
+}
+
+HashLiteral::HashLiteral(const Token &token, std::vector<std::pair<Statement *, Statement *> > pairs) : Statement(
+        token), pairs{std::move(pairs)} {
+}
+
+NodeKind HashLiteral::kind() const {
+    return NodeKind::HASH_LITERAL;
+}
+
+std::size_t HashLiteral::hashFields() const {
+    auto seed = pairs.size();
+    for (const auto &[key, value]: pairs) {
+        boost::hash_combine(seed, key->hash());
+        boost::hash_combine(seed, value->hash());
+    }
+    return seed;
+}
+
+int HashLiteral::compareFields(const Statement &s) const {
+    const auto &other = static_cast<const HashLiteral &>(s);
+    if (const auto c = ASTUtil::compare(pairs.size(), other.pairs.size()); c != 0) {
+        return c;
+    }
+    for (auto a = pairs.begin(), b = other.pairs.begin(); a != pairs.end(); ++a, ++b) {
+        if (const auto c = a->first->compare(*b->first); c != 0) {
+            return c;
+        }
+        if (const auto c = a->second->compare(*b->second); c != 0) {
+            return c;
+        }
+    }
+    return 0;
+}
+
+void HashLiteral::print(std::ostream &out) const {
+    out << "{";
+    auto first = true;
+    for (const auto &[key, value]: pairs) {
+        if (!first) {
+            out << ", ";
+        }
+        first = false;
+        key->print(out);
+        out << ":";
+        value->print(out);
+    }
+    out << "}";
 }
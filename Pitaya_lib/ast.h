@@ -1,15 +1,65 @@
 #ifndef PITAYA_AST_H
 #define PITAYA_AST_H
 
-#include <map>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <optional>
+#include <ostream>
 
+#include "arena.h"
+#include "symbols.h"
 #include "tokens.h"
 
+// Child lists of nodes aren't const like their other fields: constructors take them by value and move them
+// in, and moving a node (see Parser::make) takes them along instead of copying them
 #define OPT_STATEMENT_LIST std::optional<std::vector<std::optional<Statement *> > >
 
+enum struct NodeKind : std::uint8_t {
+    STATEMENT,
+    IDENTIFIER,
+    STRING_LITERAL,
+    LET_STATEMENT,
+    RETURN_STATEMENT,
+    EXPRESSION_STATEMENT,
+    INTEGER_LITERAL,
+    BOOLEAN_LITERAL,
+    PREFIX_EXPRESSION,
+    INFIX_EXPRESSION,
+    CALL_EXPRESSION,
+    ARRAY_LITERAL,
+    INDEX_EXPRESSION,
+    BLOCK_STATEMENT,
+    IF_EXPRESSION,
+    FUNCTION_LITERAL,
+    HASH_LITERAL,
+};
+
+inline const char *to_string(const NodeKind e) {
+    switch (e) {
+        case NodeKind::STATEMENT: return "STATEMENT";
+        case NodeKind::IDENTIFIER: return "IDENTIFIER";
+        case NodeKind::STRING_LITERAL: return "STRING_LITERAL";
+        case NodeKind::LET_STATEMENT: return "LET_STATEMENT";
+        case NodeKind::RETURN_STATEMENT: return "RETURN_STATEMENT";
+        case NodeKind::EXPRESSION_STATEMENT: return "EXPRESSION_STATEMENT";
+        case NodeKind::INTEGER_LITERAL: return "INTEGER_LITERAL";
+        case NodeKind::BOOLEAN_LITERAL: return "BOOLEAN_LITERAL";
+        case NodeKind::PREFIX_EXPRESSION: return "PREFIX_EXPRESSION";
+        case NodeKind::INFIX_EXPRESSION: return "INFIX_EXPRESSION";
+        case NodeKind::CALL_EXPRESSION: return "CALL_EXPRESSION";
+        case NodeKind::ARRAY_LITERAL: return "ARRAY_LITERAL";
+        case NodeKind::INDEX_EXPRESSION: return "INDEX_EXPRESSION";
+        case NodeKind::BLOCK_STATEMENT: return "BLOCK_STATEMENT";
+        case NodeKind::IF_EXPRESSION: return "IF_EXPRESSION";
+        case NodeKind::FUNCTION_LITERAL: return "FUNCTION_LITERAL";
+        case NodeKind::HASH_LITERAL: return "HASH_LITERAL";
+        default: return "unknown";
+    }
+}
+
 //
 struct Statement {
     virtual ~Statement() = default;
@@ -18,41 +68,101 @@ struct Statement {
 
     const Token token;
 
-    [[nodiscard]] std::string tokenLiteral() const;
+    [[nodiscard]] std::string_view tokenLiteral() const;
+
+    // writes the node into out in a single pass, without building intermediate strings for the children
+    virtual void print(std::ostream &out) const;
+
+    [[nodiscard]] std::string to_string() const;
+
+    [[nodiscard]] virtual NodeKind kind() const;
+
+    // Structural hash of the subtree rooted here, computed once and cached in the node
+    [[nodiscard]] std::size_t hash() const;
 
-    [[nodiscard]] virtual std::string to_string() const;
+    // Structural total order: nodes compare equal exactly when their subtrees have the same shape and values
+    [[nodiscard]] int compare(const Statement &s) const;
+
+    bool operator==(const Statement &s) const;
 
     bool operator<(const Statement &s) const;
+
+    // the parts of hash() and compare() that depend on the concrete node type; s always has the same kind()
+    [[nodiscard]] virtual std::size_t hashFields() const;
+
+    [[nodiscard]] virtual int compareFields(const Statement &s) const;
+
+private:
+    mutable std::size_t cachedHash = 0;
+};
+
+// Functors to key containers by the structure of the pointed-to nodes rather than by address
+struct StatementHash {
+    std::size_t operator()(const Statement *statement) const;
+};
+
+struct StatementEqual {
+    bool operator()(const Statement *a, const Statement *b) const;
+};
+
+struct StatementLess {
+    bool operator()(const Statement *a, const Statement *b) const;
 };
 
 struct Program {
-    explicit Program(const std::vector<Statement *> &statements);
+    explicit Program(std::vector<Statement *> statements,
+                     std::shared_ptr<ParseArena> arena = nullptr,
+                     std::shared_ptr<const void> source = nullptr,
+                     std::shared_ptr<const SymbolTable> symbols = nullptr);
 
     const std::vector<Statement *> statements;
+    // owns every node reachable from statements
+    const std::shared_ptr<ParseArena> arena;
+    // keeps alive the text every token literal points into: the source string, a MappedFile, ...
+    const std::shared_ptr<const void> source;
+    // the names every Identifier and StringLiteral value points into
+    const std::shared_ptr<const SymbolTable> symbols;
+
+    void print(std::ostream &out) const;
 
     [[nodiscard]] std::string to_string() const;
 };
 
 struct StringValue : Statement {
-    StringValue(const Token &token, std::string value);
+    StringValue(const Token &token, Symbol symbol);
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] std::size_t hashFields() const override;
 
-    const std::string value;
+    [[nodiscard]] int compareFields(const Statement &s) const override;
+
+    void print(std::ostream &out) const override;
+
+    const SymbolId symbol;
+    const std::string_view value;
 };
 
 struct Identifier final : StringValue {
-    Identifier(const Token &token, const std::string &value);
+    Identifier(const Token &token, Symbol symbol);
+
+    [[nodiscard]] NodeKind kind() const override;
 };
 
 struct StringLiteral final :StringValue {
-    StringLiteral(const Token &token, const std::string &value);
+    StringLiteral(const Token &token, Symbol symbol);
+
+    [[nodiscard]] NodeKind kind() const override;
 };
 
 struct LetStatement final : Statement {
     LetStatement(const Token &token, Identifier name, std::optional<Statement *> value);
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] NodeKind kind() const override;
+
+    [[nodiscard]] std::size_t hashFields() const override;
+
+    [[nodiscard]] int compareFields(const Statement &s) const override;
+
+    void print(std::ostream &out) const override;
 
     const Identifier name;
     const std::optional<Statement *> value;
@@ -61,7 +171,13 @@ struct LetStatement final : Statement {
 struct ReturnStatement final : Statement {
     ReturnStatement(const Token &token, const std::optional<Statement *> &returnValue);
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] NodeKind kind() const override;
+
+    [[nodiscard]] std::size_t hashFields() const override;
+
+    [[nodiscard]] int compareFields(const Statement &s) const override;
+
+    void print(std::ostream &out) const override;
 
     const std::optional<Statement *> returnValue;
 };
@@ -69,7 +185,13 @@ struct ReturnStatement final : Statement {
 struct ExpressionStatement final : Statement {
     ExpressionStatement(const Token &token, const std::optional<Statement *> &expression);
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] NodeKind kind() const override;
+
+    [[nodiscard]] std::size_t hashFields() const override;
+
+    [[nodiscard]] int compareFields(const Statement &s) const override;
+
+    void print(std::ostream &out) const override;
 
     const std::optional<Statement *> expression;
 };
@@ -78,78 +200,121 @@ template<typename T>
 struct LiteralExpression : Statement {
     LiteralExpression(const Token &token, T value);
 
-    // std::string to_string() const override;
+    [[nodiscard]] std::size_t hashFields() const override;
+
+    [[nodiscard]] int compareFields(const Statement &s) const override;
+
     const T value;
 };
 
 struct IntegerLiteral final : LiteralExpression<long> {
     IntegerLiteral(const Token &token, long value);
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] NodeKind kind() const override;
+
+    void print(std::ostream &out) const override;
 };
 
 struct BooleanLiteral final : LiteralExpression<bool> {
     BooleanLiteral(const Token &token, bool value);
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] NodeKind kind() const override;
+
+    void print(std::ostream &out) const override;
 };
 
 struct PrefixExpression final : Statement {
-    PrefixExpression(const Token &token, std::string op, std::optional<Statement *> right);
+    PrefixExpression(const Token &token, std::string_view op, std::optional<Statement *> right);
+
+    [[nodiscard]] NodeKind kind() const override;
+
+    [[nodiscard]] std::size_t hashFields() const override;
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] int compareFields(const Statement &s) const override;
 
-    const std::string op;
+    void print(std::ostream &out) const override;
+
+    const std::string_view op;
     const std::optional<Statement *> right;
 };
 
 struct InfixExpression final : Statement {
     InfixExpression(const Token &token,
                     std::optional<Statement *> left,
-                    std::string op,
+                    std::string_view op,
                     std::optional<Statement *> right);
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] NodeKind kind() const override;
+
+    [[nodiscard]] std::size_t hashFields() const override;
+
+    [[nodiscard]] int compareFields(const Statement &s) const override;
+
+    void print(std::ostream &out) const override;
 
     const std::optional<Statement *> left;
-    const std::string op;
+    const std::string_view op;
     const std::optional<Statement *> right;
 };
 
 struct CallExpression final : Statement {
     CallExpression(const Token &token,
                    std::optional<Statement *> function,
-                   const OPT_STATEMENT_LIST &arguments);
+                   OPT_STATEMENT_LIST arguments);
+
+    [[nodiscard]] NodeKind kind() const override;
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] std::size_t hashFields() const override;
+
+    [[nodiscard]] int compareFields(const Statement &s) const override;
+
+    void print(std::ostream &out) const override;
 
     const std::optional<Statement *> function;
-    const OPT_STATEMENT_LIST arguments;
+    OPT_STATEMENT_LIST arguments;
 };
 
 struct ArrayLiteral final : Statement {
-    ArrayLiteral(const Token &token, const OPT_STATEMENT_LIST &elements);
+    ArrayLiteral(const Token &token, OPT_STATEMENT_LIST elements);
+
+    [[nodiscard]] NodeKind kind() const override;
+
+    [[nodiscard]] std::size_t hashFields() const override;
+
+    [[nodiscard]] int compareFields(const Statement &s) const override;
 
-    [[nodiscard]] std::string to_string() const override;
+    void print(std::ostream &out) const override;
 
-    const OPT_STATEMENT_LIST elements;
+    OPT_STATEMENT_LIST elements;
 };
 
 struct IndexExpression final : Statement {
     IndexExpression(const Token &token, std::optional<Statement *> left, std::optional<Statement *> index);
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] NodeKind kind() const override;
+
+    [[nodiscard]] std::size_t hashFields() const override;
+
+    [[nodiscard]] int compareFields(const Statement &s) const override;
+
+    void print(std::ostream &out) const override;
 
     const std::optional<Statement *> left;
     const std::optional<Statement *> index;
 };
 
 struct BlockStatement final : Statement {
-    BlockStatement(const Token &token, const OPT_STATEMENT_LIST &statements);
+    BlockStatement(const Token &token, OPT_STATEMENT_LIST statements);
+
+    [[nodiscard]] NodeKind kind() const override;
+
+    [[nodiscard]] std::size_t hashFields() const override;
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] int compareFields(const Statement &s) const override;
 
-    const OPT_STATEMENT_LIST statements;
+    void print(std::ostream &out) const override;
+
+    OPT_STATEMENT_LIST statements;
 };
 
 struct IfExpression final : Statement {
@@ -158,25 +323,81 @@ struct IfExpression final : Statement {
                  std::optional<BlockStatement *> consequence,
                  std::optional<BlockStatement *> alternative);
 
-    [[nodiscard]] std::string to_string() const override;
+    [[nodiscard]] NodeKind kind() const override;
+
+    [[nodiscard]] std::size_t hashFields() const override;
+
+    [[nodiscard]] int compareFields(const Statement &s) const override;
+
+    void print(std::ostream &out) const override;
 
     const std::optional<Statement *> condition;
     const std::optional<BlockStatement *> consequence;
     const std::optional<BlockStatement *> alternative;
 };
 
+// A function body the parser skipped over, to be parsed the first time it is needed (see
+// ParserOptions::lazyFunctionBodies). Lives in the same arena as the FunctionLiteral pointing at it.
+struct DeferredBody {
+    // parses the body on the first call and returns the same block on every later one; safe to call from several
+    // threads
+    [[nodiscard]] virtual BlockStatement *parse() const = 0;
+
+    [[nodiscard]] virtual bool parsed() const = 0;
+
+    // errors found in the body, empty until parse() ran
+    [[nodiscard]] virtual std::vector<std::string> errors() const = 0;
+
+protected:
+    // not virtual, so the arena never has to run a destructor for a body
+    ~DeferredBody() = default;
+};
+
 struct FunctionLiteral final : Statement {
     FunctionLiteral(const Token &token,
-                    const std::optional<std::vector<Identifier *> > &parameters,
+                    std::optional<std::vector<Identifier *> > parameters,
                     std::optional<BlockStatement *> body);
 
-    const std::optional<std::vector<Identifier *> > parameters;
-    const std::optional<BlockStatement *> body;
+    FunctionLiteral(const Token &token,
+                    std::optional<std::vector<Identifier *> > parameters,
+                    const DeferredBody *deferred);
+
+    [[nodiscard]] NodeKind kind() const override;
+
+    [[nodiscard]] std::size_t hashFields() const override;
+
+    [[nodiscard]] int compareFields(const Statement &s) const override;
+
+    void print(std::ostream &out) const override;
+
+    // parses a deferred body on first use, and so do hash() and compare()
+    [[nodiscard]] std::optional<BlockStatement *> body() const;
+
+    // whether body() still has to parse the body
+    [[nodiscard]] bool deferred() const;
+
+    // errors of a deferred body, reported here instead of by the parser that skipped it
+    [[nodiscard]] std::vector<std::string> bodyErrors() const;
+
+    std::optional<std::vector<Identifier *> > parameters;
     std::string name;
+
+private:
+    const std::optional<BlockStatement *> parsedBody;
+    const DeferredBody *const deferredBody = nullptr;
 };
 
 struct HashLiteral final :Statement {
-    HashLiteral(const Token &token, const std::map<Statement *, Statement *> &pairs);
-    const std::map<Statement *, Statement *> pairs;
+    HashLiteral(const Token &token, std::vector<std::pair<Statement *, Statement *> > pairs);
+
+    [[nodiscard]] NodeKind kind() const override;
+
+    [[nodiscard]] std::size_t hashFields() const override;
+
+    [[nodiscard]] int compareFields(const Statement &s) const override;
+
+    void print(std::ostream &out) const override;
+    // in source order, repeated keys included: each key is still an expression to evaluate
+    std::vector<std::pair<Statement *, Statement *> > pairs;
 };
 #endif //PITAYA_AST_H
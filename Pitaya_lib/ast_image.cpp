@@ -0,0 +1,75 @@
+#include "ast_image.h"
+
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+#include <unistd.h>
+
+#include "flat_ast.h"
+#include "mapped_file.h"
+
+namespace AstImageUtil {
+    std::unique_ptr<Program> load(const std::string &imagePath, const std::uint64_t sourceHash) {
+        try {
+            const auto image = MappedFile::open(imagePath);
+            const auto ast = FlatAst::read(image->text(), sourceHash);
+            return ast.has_value() ? std::unique_ptr<Program>{ast->inflate()} : nullptr;
+        } catch (const std::system_error &) {
+            return nullptr;
+        }
+    }
+
+    // A name next to imagePath that no other process or thread writing the same image picks at the same time
+    std::string temporaryPath(const std::string &imagePath) {
+        static std::atomic<std::uint64_t> written = 0;
+        std::stringstream path;
+        path << imagePath << "." << ::getpid() << "." << written.fetch_add(1, std::memory_order_relaxed) << ".tmp";
+        return path.str();
+    }
+
+    // written next to the image and renamed over it, so a reader never maps a half-written image
+    void store(const std::string &imagePath, const Program &program, const std::uint64_t sourceHash) {
+        const auto temporary = temporaryPath(imagePath);
+        {
+            std::ofstream out{temporary, std::ios::binary | std::ios::trunc};
+            FlatAst::from(program).write(out, sourceHash);
+            if (!out.flush()) {
+                out.close();
+                std::remove(temporary.c_str());
+                return;
+            }
+        }
+        if (std::rename(temporary.c_str(), imagePath.c_str()) != 0) {
+            std::remove(temporary.c_str());
+        }
+    }
+}
+
+ParsedFile parseFileCached(const std::string &path, const std::string &imagePath, ParserOptions options) {
+    ParsedFile result{path, nullptr, {}};
+    try {
+        const auto file = MappedFile::open(path);
+        const auto sourceHash = FlatAst::hashSource(file->text());
+        result.program = AstImageUtil::load(imagePath, sourceHash);
+        if (result.program != nullptr) {
+            return result;
+        }
+        // the image needs every body, and deferred bodies would report their errors too late to leave it unwritten
+        options.lazyFunctionBodies = false;
+        Parser parser{Lexer{file->text(), file}, options};
+        result.program.reset(parser.parseProgram());
+        result.errors = std::move(parser.errors);
+        if (result.errors.empty()) {
+            AstImageUtil::store(imagePath, *result.program, sourceHash);
+        }
+    } catch (const std::exception &e) {
+        std::stringstream stream;
+        stream << "failed to parse " << path << ": " << e.what();
+        result.errors.push_back(stream.str());
+    }
+    return result;
+}
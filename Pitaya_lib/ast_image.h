@@ -0,0 +1,14 @@
+#ifndef PITAYA_AST_IMAGE_H
+#define PITAYA_AST_IMAGE_H
+
+#include <string>
+
+#include "batch.h"
+
+// Parses the file at path, going through a FlatAst image at imagePath. When the image exists and was written for
+// the current contents of path, the Program is inflated from it without running the Lexer or the Parser; otherwise
+// the file is parsed and, if it had no errors, a fresh image replaces the old one. The image is only a cache: one
+// that can't be read or written is the same as no image at all.
+ParsedFile parseFileCached(const std::string &path, const std::string &imagePath, ParserOptions options = {});
+
+#endif //PITAYA_AST_IMAGE_H
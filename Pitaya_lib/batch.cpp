@@ -0,0 +1,97 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+
+#include "mapped_file.h"
+
+namespace BatchUtil {
+    // One worker's share of the files. The owner takes from the back, thieves from the front, so they only meet
+    // on the last item.
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::size_t> items;
+
+        std::optional<std::size_t> pop() {
+            std::scoped_lock lock{mutex};
+            if (items.empty()) {
+                return std::nullopt;
+            }
+            const auto item = items.back();
+            items.pop_back();
+            return item;
+        }
+
+        std::optional<std::size_t> steal() {
+            std::scoped_lock lock{mutex};
+            if (items.empty()) {
+                return std::nullopt;
+            }
+            const auto item = items.front();
+            items.pop_front();
+            return item;
+        }
+    };
+
+    void parseFile(ParsedFile &result, const ParserOptions options) {
+        try {
+            Parser parser{lexFile(result.path), options};
+            result.program.reset(parser.parseProgram());
+            result.errors = std::move(parser.errors);
+        } catch (const std::exception &e) {
+            std::stringstream stream;
+            stream << "failed to parse " << result.path << ": " << e.what();
+            result.errors.push_back(stream.str());
+        }
+    }
+
+    void work(std::vector<WorkQueue> &queues, const std::size_t self, std::vector<ParsedFile> &results,
+              const ParserOptions options) {
+        while (true) {
+            auto item = queues[self].pop();
+            for (std::size_t i = 1; !item.has_value() && i < queues.size(); i++) {
+                item = queues[(self + i) % queues.size()].steal();
+            }
+            // nothing is ever added back, so once every queue is empty the batch is done
+            if (!item.has_value()) {
+                return;
+            }
+            parseFile(results[item.value()], options);
+        }
+    }
+}
+
+std::vector<ParsedFile> parseFiles(const std::vector<std::string> &paths, std::size_t threads,
+                                   const ParserOptions options) {
+    std::vector<ParsedFile> results(paths.size());
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        results[i].path = paths[i];
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::max<std::size_t>(1, std::min(threads, paths.size()));
+
+    // contiguous blocks, so a worker that never steals walks its files in order
+    std::vector<BatchUtil::WorkQueue> queues(threads);
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        queues[i * threads / paths.size()].items.push_back(i);
+    }
+    for (auto &queue: queues) {
+        std::ranges::reverse(queue.items);
+    }
+
+    std::vector<std::jthread> workers;
+    workers.reserve(threads - 1);
+    for (std::size_t worker = 1; worker < threads; worker++) {
+        workers.emplace_back([&, worker] { BatchUtil::work(queues, worker, results, options); });
+    }
+    BatchUtil::work(queues, 0, results, options);
+    workers.clear();
+    return results;
+}
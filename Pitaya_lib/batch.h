@@ -0,0 +1,25 @@
+#ifndef PITAYA_BATCH_H
+#define PITAYA_BATCH_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parser.h"
+
+struct ParsedFile {
+    std::string path;
+    // null when the file couldn't be mapped or the parser threw
+    std::unique_ptr<Program> program;
+    // parser errors, or the reason program is null
+    std::vector<std::string> errors;
+};
+
+// Parses every file on a work-stealing pool of `threads` workers (0 = one per hardware thread). Each file is mapped,
+// lexed in place and parsed entirely on one worker into its own arena, so workers never share an allocator. Results
+// come back in the order of paths.
+std::vector<ParsedFile> parseFiles(const std::vector<std::string> &paths, std::size_t threads,
+                                   ParserOptions options = {});
+
+#endif //PITAYA_BATCH_H
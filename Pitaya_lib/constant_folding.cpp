@@ -0,0 +1,384 @@
+#include "constant_folding.h"
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ConstantFoldingUtil {
+    // what a folded Program holds on to from its input
+    struct Input {
+        std::shared_ptr<ParseArena> arena;
+        std::shared_ptr<const void> source;
+        std::shared_ptr<const SymbolTable> symbols;
+    };
+
+    bool isLiteral(const std::optional<Statement *> node) {
+        if (!node.has_value()) {
+            return false;
+        }
+        const auto kind = node.value()->kind();
+        return kind == NodeKind::INTEGER_LITERAL || kind == NodeKind::BOOLEAN_LITERAL ||
+               kind == NodeKind::STRING_LITERAL;
+    }
+
+    // nodes of the subtree, not counting the insides of deferred function bodies
+    std::size_t count(std::optional<Statement *> node);
+
+    std::size_t count(const OPT_STATEMENT_LIST &nodes) {
+        std::size_t total = 0;
+        if (nodes.has_value()) {
+            for (const auto node: nodes.value()) {
+                total += count(node);
+            }
+        }
+        return total;
+    }
+
+    std::size_t count(const std::optional<Statement *> node) {
+        if (!node.has_value()) {
+            return 0;
+        }
+        switch (const auto statement = node.value(); statement->kind()) {
+            case NodeKind::LET_STATEMENT:
+                return 2 + count(static_cast<LetStatement *>(statement)->value);
+            case NodeKind::RETURN_STATEMENT:
+                return 1 + count(static_cast<ReturnStatement *>(statement)->returnValue);
+            case NodeKind::EXPRESSION_STATEMENT:
+                return 1 + count(static_cast<ExpressionStatement *>(statement)->expression);
+            case NodeKind::PREFIX_EXPRESSION:
+                return 1 + count(static_cast<PrefixExpression *>(statement)->right);
+            case NodeKind::INFIX_EXPRESSION: {
+                const auto infix = static_cast<InfixExpression *>(statement);
+                return 1 + count(infix->left) + count(infix->right);
+            }
+            case NodeKind::INDEX_EXPRESSION: {
+                const auto index = static_cast<IndexExpression *>(statement);
+                return 1 + count(index->left) + count(index->index);
+            }
+            case NodeKind::IF_EXPRESSION: {
+                const auto ifExpression = static_cast<IfExpression *>(statement);
+                return 1 + count(ifExpression->condition) + count(ifExpression->consequence) +
+                       count(ifExpression->alternative);
+            }
+            case NodeKind::CALL_EXPRESSION: {
+                const auto call = static_cast<CallExpression *>(statement);
+                return 1 + count(call->function) + count(call->arguments);
+            }
+            case NodeKind::FUNCTION_LITERAL: {
+                const auto function = static_cast<FunctionLiteral *>(statement);
+                const auto parameters = function->parameters.has_value() ? function->parameters->size() : 0;
+                return 1 + parameters + (function->deferred() ? 0 : count(function->body()));
+            }
+            case NodeKind::ARRAY_LITERAL:
+                return 1 + count(static_cast<ArrayLiteral *>(statement)->elements);
+            case NodeKind::BLOCK_STATEMENT:
+                return 1 + count(static_cast<BlockStatement *>(statement)->statements);
+            case NodeKind::HASH_LITERAL: {
+                std::size_t total = 1;
+                for (const auto &[key, value]: static_cast<HashLiteral *>(statement)->pairs) {
+                    total += count(key) + count(value);
+                }
+                return total;
+            }
+            default:
+                return 1;
+        }
+    }
+
+    struct Folder {
+        std::shared_ptr<ParseArena> arena = std::make_shared<ParseArena>();
+        std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>();
+
+        Statement *integer(const long value) {
+            std::array<char, 24> digits{};
+            const auto end = std::to_chars(digits.data(), digits.data() + digits.size(), value).ptr;
+            const auto size = static_cast<std::size_t>(end - digits.data());
+            const auto literal = static_cast<char *>(arena->allocate(size, alignof(char)));
+            std::memcpy(literal, digits.data(), size);
+            return arena->make<IntegerLiteral>(Token{TokenType::INT, std::string_view{literal, size}, value, true},
+                                               value);
+        }
+
+        Statement *boolean(const bool value) {
+            const auto tokenType = value ? TokenType::TRUE : TokenType::FALSE;
+            return arena->make<BooleanLiteral>(Token{tokenType, fixedLiteral(tokenType)}, value);
+        }
+
+        Statement *string(const std::string_view value) {
+            const auto symbol = symbols->intern(value);
+            return arena->make<StringLiteral>(Token{TokenType::STRING, symbol.name}, symbol);
+        }
+
+        // null when evaluating it would fail or overflow
+        Statement *prefix(const TokenType op, const Statement &right) {
+            if (op == TokenType::BANG) {
+                // only false is falsy among literals
+                return boolean(right.kind() == NodeKind::BOOLEAN_LITERAL &&
+                               !static_cast<const BooleanLiteral &>(right).value);
+            }
+            if (op == TokenType::MINUS && right.kind() == NodeKind::INTEGER_LITERAL) {
+                const auto value = static_cast<const IntegerLiteral &>(right).value;
+                return value == std::numeric_limits<long>::min() ? nullptr : integer(-value);
+            }
+            return nullptr;
+        }
+
+        Statement *infix(const Statement &left, const TokenType op, const Statement &right) {
+            if (left.kind() != right.kind()) {
+                return nullptr;
+            }
+            switch (left.kind()) {
+                case NodeKind::INTEGER_LITERAL:
+                    return integerInfix(static_cast<const IntegerLiteral &>(left).value, op,
+                                        static_cast<const IntegerLiteral &>(right).value);
+                case NodeKind::BOOLEAN_LITERAL: {
+                    const auto a = static_cast<const BooleanLiteral &>(left).value;
+                    const auto b = static_cast<const BooleanLiteral &>(right).value;
+                    if (op == TokenType::EQ || op == TokenType::NOT_EQ) {
+                        return boolean((a == b) == (op == TokenType::EQ));
+                    }
+                    return nullptr;
+                }
+                case NodeKind::STRING_LITERAL: {
+                    if (op != TokenType::PLUS) {
+                        return nullptr;
+                    }
+                    auto value = std::string{static_cast<const StringLiteral &>(left).value};
+                    value += static_cast<const StringLiteral &>(right).value;
+                    return string(value);
+                }
+                default:
+                    return nullptr;
+            }
+        }
+
+        Statement *integerInfix(const long a, const TokenType op, const long b) {
+            long result = 0;
+            switch (op) {
+                case TokenType::PLUS:
+                    return __builtin_add_overflow(a, b, &result) ? nullptr : integer(result);
+                case TokenType::MINUS:
+                    return __builtin_sub_overflow(a, b, &result) ? nullptr : integer(result);
+                case TokenType::ASTERISK:
+                    return __builtin_mul_overflow(a, b, &result) ? nullptr : integer(result);
+                case TokenType::SLASH:
+                    if (b == 0 || (a == std::numeric_limits<long>::min() && b == -1)) {
+                        return nullptr;
+                    }
+                    return integer(a / b);
+                case TokenType::LT:
+                    return boolean(a < b);
+                case TokenType::GT:
+                    return boolean(a > b);
+                case TokenType::EQ:
+                    return boolean(a == b);
+                case TokenType::NOT_EQ:
+                    return boolean(a != b);
+                default:
+                    return nullptr;
+            }
+        }
+
+        // the branch an `if` with a literal condition takes, unwrapped when it's a single expression
+        Statement *branch(const IfExpression &ifExpression, Statement *condition) {
+            const auto taken = condition->kind() != NodeKind::BOOLEAN_LITERAL ||
+                               static_cast<const BooleanLiteral *>(condition)->value;
+            const auto block = taken ? ifExpression.consequence : ifExpression.alternative;
+            if (!block.has_value()) {
+                if (!taken) {
+                    const auto empty = arena->make<BlockStatement>(
+                        Token{TokenType::LBRACE, fixedLiteral(TokenType::LBRACE)},
+                        std::optional{std::vector<std::optional<Statement *> >{}});
+                    return arena->make<IfExpression>(ifExpression.token, std::optional{condition},
+                                                     std::optional{empty}, std::nullopt);
+                }
+                return nullptr;
+            }
+            const auto folded = static_cast<BlockStatement *>(fold(block.value()));
+            if (const auto &statements = folded->statements; statements.has_value() && statements->size() == 1 &&
+                                                              statements->front().has_value() &&
+                                                              statements->front().value()->kind() ==
+                                                              NodeKind::EXPRESSION_STATEMENT) {
+                if (const auto expression = static_cast<ExpressionStatement *>(statements->front().value())->
+                            expression;
+                    expression.has_value()) {
+                    return expression.value();
+                }
+            }
+            return folded;
+        }
+
+        std::optional<Statement *> fold(const std::optional<Statement *> node) {
+            return node.has_value() ? std::optional{fold(node.value())} : std::nullopt;
+        }
+
+        std::optional<BlockStatement *> fold(const std::optional<BlockStatement *> node) {
+            return node.has_value()
+                       ? std::optional{static_cast<BlockStatement *>(fold(static_cast<Statement *>(node.value())))}
+                       : std::nullopt;
+        }
+
+        // the folded list and whether anything in it changed
+        std::pair<OPT_STATEMENT_LIST, bool> fold(const OPT_STATEMENT_LIST &nodes) {
+            if (!nodes.has_value()) {
+                return {std::nullopt, false};
+            }
+            std::vector<std::optional<Statement *> > result;
+            result.reserve(nodes->size());
+            auto changed = false;
+            for (const auto node: nodes.value()) {
+                result.push_back(fold(node));
+                changed = changed || result.back() != node;
+            }
+            return {std::move(result), changed};
+        }
+
+        // A subtree shared by a hash-consed input is folded once per place it appears, like count() counts it
+        Statement *fold(Statement *node) {
+            switch (node->kind()) {
+                case NodeKind::LET_STATEMENT: {
+                    const auto let = static_cast<LetStatement *>(node);
+                    const auto value = fold(let->value);
+                    return value == let->value ? node : arena->make<LetStatement>(let->token, let->name, value);
+                }
+                case NodeKind::RETURN_STATEMENT: {
+                    const auto statement = static_cast<ReturnStatement *>(node);
+                    const auto value = fold(statement->returnValue);
+                    return value == statement->returnValue
+                               ? node
+                               : arena->make<ReturnStatement>(statement->token, value);
+                }
+                case NodeKind::EXPRESSION_STATEMENT: {
+                    const auto statement = static_cast<ExpressionStatement *>(node);
+                    const auto expression = fold(statement->expression);
+                    return expression == statement->expression
+                               ? node
+                               : arena->make<ExpressionStatement>(statement->token, expression);
+                }
+                case NodeKind::PREFIX_EXPRESSION: {
+                    const auto prefix = static_cast<PrefixExpression *>(node);
+                    const auto right = fold(prefix->right);
+                    if (isLiteral(right)) {
+                        if (const auto value = this->prefix(prefix->token.tokenType, *right.value());
+                            value != nullptr) {
+                            return value;
+                        }
+                    }
+                    return right == prefix->right
+                               ? node
+                               : arena->make<PrefixExpression>(prefix->token, prefix->op, right);
+                }
+                case NodeKind::INFIX_EXPRESSION: {
+                    const auto infix = static_cast<InfixExpression *>(node);
+                    const auto left = fold(infix->left);
+                    const auto right = fold(infix->right);
+                    if (isLiteral(left) && isLiteral(right)) {
+                        if (const auto value = this->infix(*left.value(), infix->token.tokenType, *right.value());
+                            value != nullptr) {
+                            return value;
+                        }
+                    }
+                    return left == infix->left && right == infix->right
+                               ? node
+                               : arena->make<InfixExpression>(infix->token, left, infix->op, right);
+                }
+                case NodeKind::INDEX_EXPRESSION: {
+                    const auto index = static_cast<IndexExpression *>(node);
+                    const auto left = fold(index->left);
+                    const auto at = fold(index->index);
+                    return left == index->left && at == index->index
+                               ? node
+                               : arena->make<IndexExpression>(index->token, left, at);
+                }
+                case NodeKind::IF_EXPRESSION: {
+                    const auto ifExpression = static_cast<IfExpression *>(node);
+                    const auto condition = fold(ifExpression->condition);
+                    if (isLiteral(condition)) {
+                        if (const auto taken = branch(*ifExpression, condition.value()); taken != nullptr) {
+                            return taken;
+                        }
+                    }
+                    const auto consequence = fold(ifExpression->consequence);
+                    const auto alternative = fold(ifExpression->alternative);
+                    return condition == ifExpression->condition && consequence == ifExpression->consequence &&
+                           alternative == ifExpression->alternative
+                               ? node
+                               : arena->make<IfExpression>(ifExpression->token, condition, consequence,
+                                                           alternative);
+                }
+                case NodeKind::CALL_EXPRESSION: {
+                    const auto call = static_cast<CallExpression *>(node);
+                    const auto function = fold(call->function);
+                    auto [arguments, changed] = fold(call->arguments);
+                    return function == call->function && !changed
+                               ? node
+                               : arena->make<CallExpression>(call->token, function, std::move(arguments));
+                }
+                case NodeKind::FUNCTION_LITERAL: {
+                    const auto function = static_cast<FunctionLiteral *>(node);
+                    if (function->deferred()) {
+                        return node;
+                    }
+                    const auto body = function->body();
+                    const auto foldedBody = fold(body);
+                    if (foldedBody == body) {
+                        return node;
+                    }
+                    const auto result = arena->make<FunctionLiteral>(function->token, function->parameters,
+                                                                     foldedBody);
+                    result->name = function->name;
+                    return result;
+                }
+                case NodeKind::ARRAY_LITERAL: {
+                    const auto array = static_cast<ArrayLiteral *>(node);
+                    auto [elements, changed] = fold(array->elements);
+                    return changed ? arena->make<ArrayLiteral>(array->token, std::move(elements)) : node;
+                }
+                case NodeKind::BLOCK_STATEMENT: {
+                    const auto block = static_cast<BlockStatement *>(node);
+                    auto [statements, changed] = fold(block->statements);
+                    return changed ? arena->make<BlockStatement>(block->token, std::move(statements)) : node;
+                }
+                case NodeKind::HASH_LITERAL:
+                    return hash(static_cast<HashLiteral *>(node));
+                default:
+                    return node;
+            }
+        }
+
+        Statement *hash(HashLiteral *node) {
+            std::vector<std::pair<Statement *, Statement *> > pairs;
+            pairs.reserve(node->pairs.size());
+            auto changed = false;
+            for (const auto &[key, value]: node->pairs) {
+                const auto foldedKey = fold(key);
+                const auto foldedValue = fold(value);
+                changed = changed || foldedKey != key || foldedValue != value;
+                pairs.emplace_back(foldedKey, foldedValue);
+            }
+            return changed ? arena->make<HashLiteral>(node->token, std::move(pairs)) : node;
+        }
+    };
+}
+
+FoldResult foldConstants(const Program &program) {
+    ConstantFoldingUtil::Folder folder;
+    std::vector<Statement *> statements;
+    statements.reserve(program.statements.size());
+    std::size_t before = 0;
+    std::size_t after = 0;
+    for (const auto statement: program.statements) {
+        before += ConstantFoldingUtil::count(statement);
+        statements.push_back(folder.fold(statement));
+        after += ConstantFoldingUtil::count(statements.back());
+    }
+    auto input = std::make_shared<const ConstantFoldingUtil::Input>(program.arena, program.source, program.symbols);
+    return FoldResult{
+        std::make_unique<Program>(std::move(statements), folder.arena, std::move(input), folder.symbols),
+        before - after
+    };
+}
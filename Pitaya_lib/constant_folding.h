@@ -0,0 +1,27 @@
+#ifndef PITAYA_CONSTANT_FOLDING_H
+#define PITAYA_CONSTANT_FOLDING_H
+
+#include <cstddef>
+#include <memory>
+
+#include "ast.h"
+
+struct FoldResult {
+    std::unique_ptr<Program> program;
+    // nodes in the input minus nodes in the output
+    std::size_t eliminated;
+};
+
+// Evaluates what can be known before running a Program, following the Monkey evaluator's rules:
+//   - prefix and infix operators whose operands are integer, boolean or string literals become literals, except
+//     where evaluating them would fail (type mismatches, unknown operators, division by zero) or overflow a long
+//   - `if` with a literal condition becomes the branch it takes, or the bare expression when that branch is a single
+//     expression statement; `if (false) { ... }` without an else keeps an empty consequence, evaluating to null
+//
+// The input is left as it is. Subtrees the pass doesn't change are shared with it, and the output keeps the input's
+// arena, source and symbols alive; new nodes go into an arena of their own, and strings made by concatenation into a
+// SymbolTable of their own, which is the one output->symbols points at. Function bodies that haven't been parsed yet
+// (see ParserOptions::lazyFunctionBodies) are left unparsed and unfolded.
+FoldResult foldConstants(const Program &program);
+
+#endif //PITAYA_CONSTANT_FOLDING_H
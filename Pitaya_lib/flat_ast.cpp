@@ -0,0 +1,675 @@
+#include "flat_ast.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace FlatAstUtil {
+    struct Builder {
+        FlatAst ast;
+        std::unordered_map<std::string_view, std::uint32_t> stringIds;
+
+        std::uint32_t intern(const std::string_view value) {
+            if (const auto found = stringIds.find(value); found != stringIds.end()) {
+                return found->second;
+            }
+            const auto id = static_cast<std::uint32_t>(ast.stringCount());
+            ast.text.append(value);
+            ast.stringOffsets.push_back(static_cast<std::uint32_t>(ast.text.size()));
+            stringIds.emplace(value, id);
+            return id;
+        }
+
+        NodeIndex push(const FlatNode node) {
+            ast.nodes.push_back(node);
+            return static_cast<NodeIndex>(ast.nodes.size() - 1);
+        }
+
+        ChildRange range(const std::vector<NodeIndex> &indices) {
+            const auto first = static_cast<std::uint32_t>(ast.childIndices.size());
+            ast.childIndices.insert(ast.childIndices.end(), indices.begin(), indices.end());
+            return ChildRange{first, static_cast<std::uint32_t>(indices.size())};
+        }
+
+        ChildRange list(const OPT_STATEMENT_LIST &statements) {
+            if (!statements.has_value()) {
+                return ChildRange{};
+            }
+            std::vector<NodeIndex> indices;
+            indices.reserve(statements->size());
+            for (const auto statement: statements.value()) {
+                indices.push_back(add(statement));
+            }
+            return range(indices);
+        }
+
+        template<typename T>
+        NodeIndex add(const std::optional<T *> statement) {
+            return statement.has_value() ? add(statement.value()) : NO_NODE;
+        }
+
+        NodeIndex add(const Statement *statement) {
+            switch (statement->kind()) {
+                case NodeKind::IDENTIFIER:
+                case NodeKind::STRING_LITERAL: {
+                    const auto value = static_cast<const StringValue *>(statement);
+                    return push(FlatNode{statement->kind(), intern(value->value)});
+                }
+                case NodeKind::INTEGER_LITERAL: {
+                    ast.integers.push_back(static_cast<const IntegerLiteral *>(statement)->value);
+                    return push(FlatNode{NodeKind::INTEGER_LITERAL, static_cast<std::uint32_t>(ast.integers.size() - 1)});
+                }
+                case NodeKind::BOOLEAN_LITERAL:
+                    return push(FlatNode{NodeKind::BOOLEAN_LITERAL, static_cast<const BooleanLiteral *>(statement)->value});
+                case NodeKind::LET_STATEMENT: {
+                    const auto let = static_cast<const LetStatement *>(statement);
+                    const auto name = intern(let->name.value);
+                    return push(FlatNode{NodeKind::LET_STATEMENT, name, add(let->value)});
+                }
+                case NodeKind::RETURN_STATEMENT:
+                    return push(FlatNode{
+                        NodeKind::RETURN_STATEMENT, add(static_cast<const ReturnStatement *>(statement)->returnValue)
+                    });
+                case NodeKind::EXPRESSION_STATEMENT:
+                    return push(FlatNode{
+                        NodeKind::EXPRESSION_STATEMENT,
+                        add(static_cast<const ExpressionStatement *>(statement)->expression)
+                    });
+                case NodeKind::PREFIX_EXPRESSION: {
+                    const auto prefix = static_cast<const PrefixExpression *>(statement);
+                    const auto op = intern(prefix->op);
+                    return push(FlatNode{NodeKind::PREFIX_EXPRESSION, op, add(prefix->right)});
+                }
+                case NodeKind::INFIX_EXPRESSION: {
+                    const auto infix = static_cast<const InfixExpression *>(statement);
+                    const auto left = add(infix->left);
+                    const auto op = intern(infix->op);
+                    return push(FlatNode{NodeKind::INFIX_EXPRESSION, left, op, add(infix->right)});
+                }
+                case NodeKind::INDEX_EXPRESSION: {
+                    const auto index = static_cast<const IndexExpression *>(statement);
+                    const auto left = add(index->left);
+                    return push(FlatNode{NodeKind::INDEX_EXPRESSION, left, add(index->index)});
+                }
+                case NodeKind::IF_EXPRESSION: {
+                    const auto ifExpression = static_cast<const IfExpression *>(statement);
+                    const auto condition = add(ifExpression->condition);
+                    const auto consequence = add(ifExpression->consequence);
+                    return push(FlatNode{
+                        NodeKind::IF_EXPRESSION, condition, consequence, add(ifExpression->alternative)
+                    });
+                }
+                case NodeKind::CALL_EXPRESSION: {
+                    const auto call = static_cast<const CallExpression *>(statement);
+                    const auto function = add(call->function);
+                    const auto [first, count] = list(call->arguments);
+                    return push(FlatNode{NodeKind::CALL_EXPRESSION, function, first, count});
+                }
+                case NodeKind::FUNCTION_LITERAL: {
+                    const auto function = static_cast<const FunctionLiteral *>(statement);
+                    auto parameters = ChildRange{};
+                    if (function->parameters.has_value()) {
+                        std::vector<NodeIndex> indices;
+                        for (const auto parameter: function->parameters.value()) {
+                            indices.push_back(add(parameter));
+                        }
+                        parameters = range(indices);
+                    }
+                    return push(FlatNode{
+                        NodeKind::FUNCTION_LITERAL, add(function->body()), parameters.first, parameters.count
+                    });
+                }
+                case NodeKind::ARRAY_LITERAL: {
+                    const auto [first, count] = list(static_cast<const ArrayLiteral *>(statement)->elements);
+                    return push(FlatNode{NodeKind::ARRAY_LITERAL, NO_NODE, first, count});
+                }
+                case NodeKind::BLOCK_STATEMENT: {
+                    const auto [first, count] = list(static_cast<const BlockStatement *>(statement)->statements);
+                    return push(FlatNode{NodeKind::BLOCK_STATEMENT, NO_NODE, first, count});
+                }
+                case NodeKind::HASH_LITERAL: {
+                    std::vector<NodeIndex> indices;
+                    for (const auto &[key, value]: static_cast<const HashLiteral *>(statement)->pairs) {
+                        indices.push_back(add(key));
+                        indices.push_back(add(value));
+                    }
+                    const auto [first, count] = range(indices);
+                    return push(FlatNode{NodeKind::HASH_LITERAL, NO_NODE, first, count});
+                }
+                default:
+                    return push(FlatNode{NodeKind::STATEMENT});
+            }
+        }
+    };
+
+    constexpr std::array<char, 8> IMAGE_MAGIC{'P', 'I', 'T', 'A', 'Y', 'A', 'S', 'T'};
+    constexpr std::uint32_t IMAGE_BYTE_ORDER = 0x01020304;
+
+    struct ImageHeader {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        // an image is only read back on the ABI that wrote it
+        std::uint32_t nodeSize;
+        std::uint32_t integerSize;
+        std::uint64_t sourceHash;
+        std::uint64_t nodes;
+        std::uint64_t childIndices;
+        std::uint64_t integers;
+        std::uint64_t stringOffsets;
+        std::uint64_t text;
+        ChildRange statements;
+    };
+
+    std::size_t padded(const std::size_t bytes) {
+        return (bytes + 7) & ~std::size_t{7};
+    }
+
+    template<typename T>
+    void writePool(std::ostream &out, const T *data, const std::size_t count) {
+        constexpr std::array<char, 8> padding{};
+        const auto bytes = count * sizeof(T);
+        out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        out.write(padding.data(), static_cast<std::streamsize>(padded(bytes) - bytes));
+    }
+
+    // copies the next pool of image into pool, false when image is too short
+    template<typename T>
+    bool readPool(std::string_view &image, const std::uint64_t count, T &pool) {
+        using Value = std::remove_reference_t<decltype(pool[0])>;
+        if (count > image.size() / sizeof(Value) || padded(count * sizeof(Value)) > image.size()) {
+            return false;
+        }
+        const auto bytes = static_cast<std::size_t>(count) * sizeof(Value);
+        pool.resize(static_cast<std::size_t>(count));
+        std::memcpy(pool.data(), image.data(), bytes);
+        image.remove_prefix(padded(bytes));
+        return true;
+    }
+
+    // Checks every reference of every node, so inflate() and print() can trust an image read from disk. Children
+    // must come before their parent, which also rules out cycles, and the ones inflate() builds as a BlockStatement
+    // or an Identifier must be of that kind.
+    bool valid(const FlatAst &ast) {
+        const auto &offsets = ast.stringOffsets;
+        if (offsets.empty() || offsets.front() != 0 || offsets.back() != ast.text.size() ||
+            !std::ranges::is_sorted(offsets)) {
+            return false;
+        }
+        const auto strings = ast.stringCount();
+        const auto childOf = [](const std::uint32_t index, const NodeIndex parent) {
+            return index == NO_NODE || index < parent;
+        };
+        const auto rangeOf = [&ast, &childOf](const ChildRange range, const NodeIndex parent) {
+            if (range.first == NO_NODE) {
+                return true;
+            }
+            if (range.first > ast.childIndices.size() || range.count > ast.childIndices.size() - range.first) {
+                return false;
+            }
+            return std::ranges::all_of(ast.children(range), [&](const NodeIndex c) { return childOf(c, parent); });
+        };
+        // for a child that already passed childOf
+        const auto kindOf = [&ast](const std::uint32_t index, const NodeKind kind) {
+            return index == NO_NODE || ast.nodes[index].kind == kind;
+        };
+        const auto identifiers = [&ast](const ChildRange range) {
+            return std::ranges::all_of(ast.children(range), [&ast](const NodeIndex c) {
+                return c != NO_NODE && ast.nodes[c].kind == NodeKind::IDENTIFIER;
+            });
+        };
+        for (NodeIndex i = 0; i < ast.nodes.size(); i++) {
+            const auto &node = ast.nodes[i];
+            auto ok = true;
+            switch (node.kind) {
+                case NodeKind::IDENTIFIER:
+                case NodeKind::STRING_LITERAL:
+                    ok = node.a < strings;
+                    break;
+                case NodeKind::INTEGER_LITERAL:
+                    ok = node.a < ast.integers.size();
+                    break;
+                case NodeKind::BOOLEAN_LITERAL:
+                    ok = node.a <= 1;
+                    break;
+                case NodeKind::LET_STATEMENT:
+                case NodeKind::PREFIX_EXPRESSION:
+                    ok = node.a < strings && childOf(node.b, i);
+                    break;
+                case NodeKind::RETURN_STATEMENT:
+                case NodeKind::EXPRESSION_STATEMENT:
+                    ok = childOf(node.a, i);
+                    break;
+                case NodeKind::INFIX_EXPRESSION:
+                    ok = childOf(node.a, i) && node.b < strings && childOf(node.c, i);
+                    break;
+                case NodeKind::INDEX_EXPRESSION:
+                    ok = childOf(node.a, i) && childOf(node.b, i);
+                    break;
+                case NodeKind::IF_EXPRESSION:
+                    ok = childOf(node.a, i) && childOf(node.b, i) && childOf(node.c, i) &&
+                         kindOf(node.b, NodeKind::BLOCK_STATEMENT) && kindOf(node.c, NodeKind::BLOCK_STATEMENT);
+                    break;
+                case NodeKind::CALL_EXPRESSION:
+                    ok = childOf(node.a, i) && rangeOf(node.range(), i);
+                    break;
+                case NodeKind::FUNCTION_LITERAL:
+                    ok = childOf(node.a, i) && rangeOf(node.range(), i) && kindOf(node.a, NodeKind::BLOCK_STATEMENT) &&
+                         identifiers(node.range());
+                    break;
+                case NodeKind::ARRAY_LITERAL:
+                case NodeKind::BLOCK_STATEMENT:
+                case NodeKind::HASH_LITERAL:
+                    ok = rangeOf(node.range(), i);
+                    break;
+                case NodeKind::STATEMENT:
+                    break;
+                default:
+                    ok = false;
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        return rangeOf(ast.statements, static_cast<NodeIndex>(ast.nodes.size()));
+    }
+
+    // the operator whose spelling is op, ILLEGAL when there's none
+    TokenType operatorType(const std::string_view op) {
+        for (std::size_t tt = 0; tt < TOKEN_TYPE_COUNT; tt++) {
+            if (fixedLiteral(static_cast<TokenType>(tt)) == op) {
+                return static_cast<TokenType>(tt);
+            }
+        }
+        return TokenType::ILLEGAL;
+    }
+
+    struct Inflater {
+        explicit Inflater(const FlatAst &ast) : ast{ast}, symbols(ast.stringCount()), operators(ast.stringCount()),
+                                                built(ast.nodes.size()) {
+        }
+
+        const FlatAst &ast;
+        std::shared_ptr<ParseArena> arena = std::make_shared<ParseArena>();
+        std::shared_ptr<SymbolTable> table = std::make_shared<SymbolTable>();
+        // interned on first use, so operators don't end up in the table
+        std::vector<std::optional<Symbol> > symbols;
+        // looked up on first use too, operators repeat far more often than there are distinct ones
+        std::vector<std::optional<TokenType> > operators;
+        // children are built before their parents, so one forward pass fills this in
+        std::vector<Statement *> built;
+
+        Symbol symbol(const std::uint32_t id) {
+            if (!symbols[id].has_value()) {
+                symbols[id] = table->intern(ast.string(id));
+            }
+            return symbols[id].value();
+        }
+
+        [[nodiscard]] std::optional<Statement *> child(const NodeIndex index) const {
+            return index == NO_NODE || built[index] == nullptr ? std::nullopt : std::optional{built[index]};
+        }
+
+        template<typename T>
+        [[nodiscard]] std::optional<T *> childAs(const NodeIndex index) const {
+            const auto node = child(index);
+            return node.has_value() ? std::optional{static_cast<T *>(node.value())} : std::nullopt;
+        }
+
+        [[nodiscard]] OPT_STATEMENT_LIST list(const ChildRange range) const {
+            if (range.first == NO_NODE) {
+                return std::nullopt;
+            }
+            std::vector<std::optional<Statement *> > statements;
+            statements.reserve(range.count);
+            for (const auto index: ast.children(range)) {
+                statements.push_back(child(index));
+            }
+            return statements;
+        }
+
+        // The node holding the first token of the expression at index, which the parser gives to its statement.
+        // Parentheses aren't kept, so for "(a + b)" this is a rather than "(".
+        [[nodiscard]] std::optional<Statement *> leftmost(NodeIndex index) const {
+            while (index != NO_NODE) {
+                const auto &node = ast.nodes[index];
+                if ((node.kind != NodeKind::INFIX_EXPRESSION && node.kind != NodeKind::CALL_EXPRESSION &&
+                     node.kind != NodeKind::INDEX_EXPRESSION) || node.a == NO_NODE) {
+                    break;
+                }
+                index = node.a;
+            }
+            return child(index);
+        }
+
+        static Token fixed(const TokenType tokenType) {
+            return Token{tokenType, fixedLiteral(tokenType)};
+        }
+
+        // an operator token, with op pointing at its static spelling when it has one
+        std::pair<Token, std::string_view> op(const std::uint32_t id) {
+            if (!operators[id].has_value()) {
+                operators[id] = operatorType(ast.string(id));
+            }
+            if (const auto tokenType = operators[id].value(); tokenType != TokenType::ILLEGAL) {
+                return {fixed(tokenType), fixedLiteral(tokenType)};
+            }
+            const auto name = symbol(id).name;
+            return {Token{TokenType::ILLEGAL, name}, name};
+        }
+
+        Statement *build(const FlatNode &node) {
+            const auto &[kind, a, b, c] = node;
+            switch (kind) {
+                case NodeKind::IDENTIFIER: {
+                    const auto name = symbol(a);
+                    return arena->make<Identifier>(Token{TokenType::IDENT, name.name}, name);
+                }
+                case NodeKind::STRING_LITERAL: {
+                    const auto value = symbol(a);
+                    return arena->make<StringLiteral>(Token{TokenType::STRING, value.name}, value);
+                }
+                case NodeKind::INTEGER_LITERAL: {
+                    const auto value = ast.integers[a];
+                    std::array<char, 24> digits{};
+                    const auto end = std::to_chars(digits.data(), digits.data() + digits.size(), value).ptr;
+                    const auto size = static_cast<std::size_t>(end - digits.data());
+                    const auto literal = static_cast<char *>(arena->allocate(size, alignof(char)));
+                    std::memcpy(literal, digits.data(), size);
+                    return arena->make<IntegerLiteral>(
+                        Token{TokenType::INT, std::string_view{literal, size}, value, true}, value);
+                }
+                case NodeKind::BOOLEAN_LITERAL:
+                    return arena->make<BooleanLiteral>(fixed(a ? TokenType::TRUE : TokenType::FALSE), a != 0);
+                case NodeKind::LET_STATEMENT: {
+                    const auto name = symbol(a);
+                    return arena->make<LetStatement>(fixed(TokenType::LET),
+                                                     Identifier{Token{TokenType::IDENT, name.name}, name}, child(b));
+                }
+                case NodeKind::RETURN_STATEMENT:
+                    return arena->make<ReturnStatement>(fixed(TokenType::RETURN), child(a));
+                case NodeKind::EXPRESSION_STATEMENT: {
+                    const auto first = leftmost(a);
+                    const auto token = first.has_value() ? first.value()->token : fixed(TokenType::ILLEGAL);
+                    return arena->make<ExpressionStatement>(token, child(a));
+                }
+                case NodeKind::PREFIX_EXPRESSION: {
+                    const auto [token, spelling] = op(a);
+                    return arena->make<PrefixExpression>(token, spelling, child(b));
+                }
+                case NodeKind::INFIX_EXPRESSION: {
+                    const auto [token, spelling] = op(b);
+                    return arena->make<InfixExpression>(token, child(a), spelling, child(c));
+                }
+                case NodeKind::INDEX_EXPRESSION:
+                    return arena->make<IndexExpression>(fixed(TokenType::LBRACKET), child(a), child(b));
+                case NodeKind::IF_EXPRESSION:
+                    return arena->make<IfExpression>(fixed(TokenType::IF), child(a), childAs<BlockStatement>(b),
+                                                     childAs<BlockStatement>(c));
+                case NodeKind::CALL_EXPRESSION:
+                    return arena->make<CallExpression>(fixed(TokenType::LPAREN), child(a), list(node.range()));
+                case NodeKind::FUNCTION_LITERAL: {
+                    std::optional<std::vector<Identifier *> > parameters;
+                    if (b != NO_NODE) {
+                        parameters.emplace();
+                        for (const auto index: ast.children(node.range())) {
+                            if (const auto parameter = childAs<Identifier>(index); parameter.has_value()) {
+                                parameters->push_back(parameter.value());
+                            }
+                        }
+                    }
+                    return arena->make<FunctionLiteral>(fixed(TokenType::FUNCTION), std::move(parameters),
+                                                        childAs<BlockStatement>(a));
+                }
+                case NodeKind::ARRAY_LITERAL:
+                    return arena->make<ArrayLiteral>(fixed(TokenType::LBRACKET), list(node.range()));
+                case NodeKind::BLOCK_STATEMENT:
+                    return arena->make<BlockStatement>(fixed(TokenType::LBRACE), list(node.range()));
+                case NodeKind::HASH_LITERAL: {
+                    std::vector<std::pair<Statement *, Statement *> > pairs;
+                    const auto indices = ast.children(node.range());
+                    for (std::size_t i = 0; i + 1 < indices.size(); i += 2) {
+                        const auto key = child(indices[i]);
+                        const auto value = child(indices[i + 1]);
+                        if (key.has_value() && value.has_value()) {
+                            pairs.emplace_back(key.value(), value.value());
+                        }
+                    }
+                    return arena->make<HashLiteral>(fixed(TokenType::LBRACE), std::move(pairs));
+                }
+                default:
+                    return nullptr;
+            }
+        }
+    };
+
+    void join(const FlatAst &ast, std::ostream &out, const ChildRange range, const std::string_view separator) {
+        if (range.first == NO_NODE) {
+            return;
+        }
+        auto first = true;
+        for (const auto child: ast.children(range)) {
+            if (!first) {
+                out << separator;
+            }
+            first = false;
+            ast.print(out, child);
+        }
+    }
+}
+
+ChildRange FlatNode::range() const {
+    return ChildRange{b, c};
+}
+
+FlatAst FlatAst::from(const Program &program) {
+    FlatAstUtil::Builder builder;
+    std::vector<NodeIndex> statements;
+    statements.reserve(program.statements.size());
+    for (const auto statement: program.statements) {
+        statements.push_back(builder.add(statement));
+    }
+    builder.ast.statements = builder.range(statements);
+    return std::move(builder.ast);
+}
+
+const FlatNode &FlatAst::node(const NodeIndex index) const {
+    return nodes[index];
+}
+
+std::span<const NodeIndex> FlatAst::children(const ChildRange range) const {
+    if (range.first == NO_NODE) {
+        return {};
+    }
+    return std::span{childIndices}.subspan(range.first, range.count);
+}
+
+std::string_view FlatAst::string(const std::uint32_t id) const {
+    return std::string_view{text}.substr(stringOffsets[id], stringOffsets[id + 1] - stringOffsets[id]);
+}
+
+std::size_t FlatAst::stringCount() const {
+    return stringOffsets.size() - 1;
+}
+
+std::size_t FlatAst::bytes() const {
+    return nodes.size() * sizeof(FlatNode) + childIndices.size() * sizeof(NodeIndex) +
+           integers.size() * sizeof(long) + stringOffsets.size() * sizeof(std::uint32_t) + text.size();
+}
+
+void FlatAst::print(std::ostream &out) const {
+    for (const auto statement: children(statements)) {
+        print(out, statement);
+    }
+}
+
+void FlatAst::print(std::ostream &out, const NodeIndex index) const {
+    if (index == NO_NODE) {
+        return;
+    }
+    const auto &[kind, a, b, c] = nodes[index];
+    switch (kind) {
+        case NodeKind::IDENTIFIER:
+        case NodeKind::STRING_LITERAL:
+            out << string(a);
+            break;
+        case NodeKind::INTEGER_LITERAL:
+            out << integers[a];
+            break;
+        case NodeKind::BOOLEAN_LITERAL:
+            out << (a ? "true" : "false");
+            break;
+        case NodeKind::LET_STATEMENT:
+            out << "let " << string(a) << " = ";
+            print(out, b);
+            out << ";";
+            break;
+        case NodeKind::RETURN_STATEMENT:
+            out << "return ";
+            print(out, a);
+            out << ";";
+            break;
+        case NodeKind::EXPRESSION_STATEMENT:
+            print(out, a);
+            break;
+        case NodeKind::PREFIX_EXPRESSION:
+            out << "(" << string(a);
+            print(out, b);
+            out << ")";
+            break;
+        case NodeKind::INFIX_EXPRESSION:
+            out << "(";
+            print(out, a);
+            out << " " << string(b) << " ";
+            print(out, c);
+            out << ")";
+            break;
+        case NodeKind::INDEX_EXPRESSION:
+            out << "(";
+            print(out, a);
+            out << "[";
+            print(out, b);
+            out << "])";
+            break;
+        case NodeKind::IF_EXPRESSION:
+            out << "if ";
+            print(out, a);
+            out << " ";
+            print(out, b);
+            if (c != NO_NODE) {
+                out << " else ";
+                print(out, c);
+            }
+            break;
+        case NodeKind::CALL_EXPRESSION:
+            print(out, a);
+            out << "(";
+            FlatAstUtil::join(*this, out, nodes[index].range(), ", ");
+            out << ")";
+            break;
+        case NodeKind::FUNCTION_LITERAL:
+            out << "fn(";
+            FlatAstUtil::join(*this, out, nodes[index].range(), ", ");
+            out << ") ";
+            print(out, a);
+            break;
+        case NodeKind::ARRAY_LITERAL:
+            out << "[";
+            FlatAstUtil::join(*this, out, nodes[index].range(), ", ");
+            out << "]";
+            break;
+        case NodeKind::BLOCK_STATEMENT:
+            FlatAstUtil::join(*this, out, nodes[index].range(), "");
+            break;
+        case NodeKind::HASH_LITERAL: {
+            out << "{";
+            const auto pairs = children(nodes[index].range());
+            for (std::size_t i = 0; i + 1 < pairs.size(); i += 2) {
+                if (i > 0) {
+                    out << ", ";
+                }
+                print(out, pairs[i]);
+                out << ":";
+                print(out, pairs[i + 1]);
+            }
+            out << "}";
+            break;
+        }
+        default:
+            out << "Statement";
+    }
+}
+
+std::optional<FlatAst> FlatAst::read(std::string_view image, const std::uint64_t sourceHash) {
+    FlatAstUtil::ImageHeader header{};
+    if (image.size() < sizeof(header)) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, image.data(), sizeof(header));
+    image.remove_prefix(FlatAstUtil::padded(sizeof(header)));
+    if (header.magic != FlatAstUtil::IMAGE_MAGIC || header.version != FLAT_AST_IMAGE_VERSION ||
+        header.byteOrder != FlatAstUtil::IMAGE_BYTE_ORDER || header.nodeSize != sizeof(FlatNode) ||
+        header.integerSize != sizeof(long) || header.sourceHash != sourceHash) {
+        return std::nullopt;
+    }
+    FlatAst ast;
+    if (!FlatAstUtil::readPool(image, header.nodes, ast.nodes) ||
+        !FlatAstUtil::readPool(image, header.childIndices, ast.childIndices) ||
+        !FlatAstUtil::readPool(image, header.integers, ast.integers) ||
+        !FlatAstUtil::readPool(image, header.stringOffsets, ast.stringOffsets) ||
+        !FlatAstUtil::readPool(image, header.text, ast.text)) {
+        return std::nullopt;
+    }
+    ast.statements = header.statements;
+    if (!FlatAstUtil::valid(ast)) {
+        return std::nullopt;
+    }
+    return ast;
+}
+
+std::uint64_t FlatAst::hashSource(const std::string_view source) {
+    std::uint64_t hash = 0xcbf29ce484222325;
+    for (const auto c: source) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+void FlatAst::write(std::ostream &out, const std::uint64_t sourceHash) const {
+    const FlatAstUtil::ImageHeader header{
+        FlatAstUtil::IMAGE_MAGIC, FLAT_AST_IMAGE_VERSION, FlatAstUtil::IMAGE_BYTE_ORDER, sizeof(FlatNode), sizeof(long),
+        sourceHash, nodes.size(), childIndices.size(), integers.size(), stringOffsets.size(), text.size(), statements
+    };
+    FlatAstUtil::writePool(out, &header, 1);
+    FlatAstUtil::writePool(out, nodes.data(), nodes.size());
+    FlatAstUtil::writePool(out, childIndices.data(), childIndices.size());
+    FlatAstUtil::writePool(out, integers.data(), integers.size());
+    FlatAstUtil::writePool(out, stringOffsets.data(), stringOffsets.size());
+    FlatAstUtil::writePool(out, text.data(), text.size());
+}
+
+Program *FlatAst::inflate() const {
+    FlatAstUtil::Inflater inflater{*this};
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        inflater.built[i] = inflater.build(nodes[i]);
+    }
+    std::vector<Statement *> program;
+    program.reserve(statements.count);
+    for (const auto index: children(statements)) {
+        if (const auto statement = inflater.child(index); statement.has_value()) {
+            program.push_back(statement.value());
+        }
+    }
+    return new Program{std::move(program), inflater.arena, nullptr, inflater.table};
+}
+
+std::string FlatAst::to_string() const {
+    std::stringstream ss;
+    print(ss);
+    return ss.str();
+}
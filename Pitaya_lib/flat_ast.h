@@ -0,0 +1,104 @@
+#ifndef PITAYA_FLAT_AST_H
+#define PITAYA_FLAT_AST_H
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast.h"
+
+using NodeIndex = std::uint32_t;
+static constexpr NodeIndex NO_NODE = std::numeric_limits<NodeIndex>::max();
+
+// Bump whenever NodeKind, FlatNode or the image layout changes, so stale images are turned down instead of misread
+static constexpr std::uint32_t FLAT_AST_IMAGE_VERSION = 1;
+
+// A run of entries in FlatAst::childIndices. A list missing because of a parse error has first == NO_NODE.
+struct ChildRange {
+    std::uint32_t first = NO_NODE;
+    std::uint32_t count = 0;
+};
+
+// One AST node: a kind tag instead of a vtable and three 32-bit fields whose meaning depends on the kind.
+// Child lists always live in (b, c) as a ChildRange.
+//   IDENTIFIER, STRING_LITERAL   a = string id
+//   INTEGER_LITERAL              a = index into integers
+//   BOOLEAN_LITERAL              a = 0 or 1
+//   LET_STATEMENT                a = name string id, b = value
+//   RETURN_STATEMENT             a = return value
+//   EXPRESSION_STATEMENT         a = expression
+//   PREFIX_EXPRESSION            a = operator string id, b = right
+//   INFIX_EXPRESSION             a = left, b = operator string id, c = right
+//   INDEX_EXPRESSION             a = left, b = index
+//   IF_EXPRESSION                a = condition, b = consequence, c = alternative
+//   CALL_EXPRESSION              a = function, (b, c) = arguments
+//   FUNCTION_LITERAL             a = body, (b, c) = parameters
+//   ARRAY_LITERAL                (b, c) = elements
+//   BLOCK_STATEMENT              (b, c) = statements
+//   HASH_LITERAL                 (b, c) = key, value, key, value...
+// Missing children are NO_NODE.
+// Records are fixed-size so that node i is nodes[i] both in memory and in an image, which read() copies in one go
+// without decoding. Leaves leave b and c unused; packing them would make images smaller but add a decoding pass
+// to every load, whose time goes into building the Program in inflate() rather than into reading the image.
+struct FlatNode {
+    NodeKind kind = NodeKind::STATEMENT;
+    std::uint32_t a = NO_NODE;
+    std::uint32_t b = NO_NODE;
+    std::uint32_t c = NO_NODE;
+
+    [[nodiscard]] ChildRange range() const;
+};
+
+// Data-oriented copy of a Program: nodes stored contiguously and addressed by 32-bit indices, integer literals and
+// interned strings in their own pools. Children are always added before their parent, so a forward walk over nodes
+// visits every child before the node that owns it.
+struct FlatAst {
+    static FlatAst from(const Program &program);
+
+    // Loads an image written by write(), copying each pool out of it in one go; image can be a mapped file. Returns
+    // nullopt when image isn't a well-formed image of this version for a source hashing to sourceHash.
+    static std::optional<FlatAst> read(std::string_view image, std::uint64_t sourceHash);
+
+    // stable 64-bit FNV-1a of a source text, to tell which source an image was made from
+    static std::uint64_t hashSource(std::string_view source);
+
+    std::vector<FlatNode> nodes;
+    std::vector<NodeIndex> childIndices;
+    std::vector<long> integers;
+    // string id i is text[stringOffsets[i], stringOffsets[i + 1])
+    std::vector<std::uint32_t> stringOffsets{0};
+    std::string text;
+    ChildRange statements;
+
+    [[nodiscard]] const FlatNode &node(NodeIndex index) const;
+
+    [[nodiscard]] std::span<const NodeIndex> children(ChildRange range) const;
+
+    [[nodiscard]] std::string_view string(std::uint32_t id) const;
+
+    [[nodiscard]] std::size_t stringCount() const;
+
+    // heap bytes used by the pools
+    [[nodiscard]] std::size_t bytes() const;
+
+    void print(std::ostream &out) const;
+
+    void print(std::ostream &out, NodeIndex index) const;
+
+    [[nodiscard]] std::string to_string() const;
+
+    // Binary image: a header with the version, the ABI it was written on and sourceHash, then every pool as raw
+    // bytes, each one 8-byte aligned
+    void write(std::ostream &out, std::uint64_t sourceHash) const;
+
+    // Rebuilds the pointer-based Program in a single forward pass over nodes, in a fresh arena and SymbolTable.
+    // Tokens point into those or at fixedLiteral spellings, so the Program doesn't need the source text.
+    [[nodiscard]] Program *inflate() const;
+};
+
+#endif //PITAYA_FLAT_AST_H
@@ -0,0 +1,179 @@
+#include "incremental.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace IncrementalUtil {
+    // a STRING token's literal leaves out the opening quote
+    std::size_t start(const Token &token, const std::string_view text) {
+        const auto offset = static_cast<std::size_t>(token.literal.data() - text.data());
+        return token.tokenType == TokenType::STRING ? offset - 1 : offset;
+    }
+}
+
+IncrementalParser::IncrementalParser(std::string text, const ParserOptions options) : options{options},
+    current{std::make_shared<const std::string>(std::move(text))} {
+    parseAll();
+    publish();
+}
+
+std::shared_ptr<const Program> IncrementalParser::edit(const TextEdit &edit) {
+    const auto offset = std::min(edit.offset, current->size());
+    const auto length = std::min(edit.length, current->size() - offset);
+    auto text = std::make_shared<std::string>();
+    text->reserve(current->size() - length + edit.replacement.size());
+    text->append(*current, 0, offset).append(edit.replacement).append(*current, offset + length);
+    current = std::move(text);
+
+    // entries[holding - 1] is the one the edit starts in; parsing restarts one before it
+    const auto holding = static_cast<std::size_t>(
+        std::ranges::upper_bound(entries, offset, {}, &Entry::start) - entries.begin());
+    const auto first = holding >= 2 ? holding - 2 : 0;
+    // the first entry starting after the edit, the earliest parsing can line up with again
+    const auto resync = static_cast<std::size_t>(
+        std::ranges::lower_bound(entries, offset + length, {}, &Entry::start) - entries.begin());
+    const auto delta = static_cast<std::ptrdiff_t>(edit.replacement.size()) - static_cast<std::ptrdiff_t>(length);
+
+    std::vector<Error> errors;
+    const auto [fresh, synced] = parse(first == 0 ? 0 : entries[first].start, resync, delta, errors);
+    lastReparsed = fresh.size();
+
+    // errors of the replaced entries make way for the new ones, the ones after them move with their text
+    const auto replacedFrom = first == 0 ? 0 : entries[first].start;
+    const auto replacedTo = synced < entries.size() ? entries[synced].start : std::numeric_limits<std::size_t>::max();
+    const auto errorsFrom = std::ranges::lower_bound(errorList, replacedFrom, {}, &Error::start);
+    const auto errorsTo = std::ranges::lower_bound(errorsFrom, errorList.end(), replacedTo, {}, &Error::start);
+    const auto inserted = errorList.insert(errorList.erase(errorsFrom, errorsTo),
+                                           std::make_move_iterator(errors.begin()), std::make_move_iterator(errors.end()));
+    std::for_each(inserted + static_cast<std::ptrdiff_t>(errors.size()), errorList.end(),
+                  [delta](Error &error) { error.start += delta; });
+
+    for (auto i = first; i < synced; i++) {
+        if (--texts[entries[i].text].uses == 0) {
+            texts[entries[i].text].text.reset();
+        }
+    }
+    for (auto i = synced; i < entries.size(); i++) {
+        entries[i].start += delta;
+    }
+    entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(first),
+                  entries.begin() + static_cast<std::ptrdiff_t>(synced));
+    entries.insert(entries.begin() + static_cast<std::ptrdiff_t>(first), fresh.begin(), fresh.end());
+
+    if (liveTexts() > INCREMENTAL_MAX_TEXTS ||
+        arena->bytesAllocated() > INCREMENTAL_MAX_ARENA_GROWTH * fullParseBytes + DEFAULT_ARENA_CHUNK_SIZE) {
+        parseAll();
+    }
+    publish();
+    return latest;
+}
+
+std::shared_ptr<const Program> IncrementalParser::program() const {
+    return latest;
+}
+
+std::string_view IncrementalParser::text() const {
+    return *current;
+}
+
+std::vector<std::string> IncrementalParser::errors() const {
+    std::vector<std::string> errors;
+    errors.reserve(errorList.size());
+    for (const auto &error: errorList) {
+        errors.push_back(error.message);
+    }
+    return errors;
+}
+
+std::size_t IncrementalParser::reparsed() const {
+    return lastReparsed;
+}
+
+void IncrementalParser::parseAll() {
+    arena = std::make_shared<ParseArena>();
+    symbols = std::make_shared<SymbolTable>();
+    lazyBodies = nullptr;
+    entries.clear();
+    errorList.clear();
+    texts.clear();
+    entries = parse(0, 0, 0, errorList).first;
+    fullParseBytes = arena->bytesAllocated();
+    lastReparsed = entries.size();
+}
+
+std::pair<std::vector<IncrementalParser::Entry>, std::size_t> IncrementalParser::parse(
+    const std::size_t from, std::size_t resync, const std::ptrdiff_t delta, std::vector<Error> &errors) {
+    const std::string_view text = *current;
+    const auto textIndex = useText(current);
+    std::vector<Entry> parsed;
+    auto synced = entries.size();
+    Parser parser{std::make_unique<Lexer>(text.substr(from)), options, arena, symbols};
+    parser.lazyBodies = lazyBodies;
+    const auto lock = parser.lockLazyBodies();
+    while (!parser.curTokenIs(TokenType::EOF_)) {
+        const auto start = IncrementalUtil::start(parser.curToken, text);
+        while (resync < entries.size() && static_cast<std::ptrdiff_t>(entries[resync].start) + delta <
+               static_cast<std::ptrdiff_t>(start)) {
+            resync++;
+        }
+        // the same text follows, so the same statements would come out of it
+        if (resync < entries.size() && static_cast<std::ptrdiff_t>(entries[resync].start) + delta ==
+            static_cast<std::ptrdiff_t>(start)) {
+            synced = resync;
+            break;
+        }
+        const auto reported = parser.errors.size();
+        const auto statement = parser.parseStatement();
+        parsed.push_back(Entry{start, statement.value_or(nullptr), textIndex});
+        for (auto i = reported; i < parser.errors.size(); i++) {
+            errors.push_back(Error{start, std::move(parser.errors[i])});
+        }
+        parser.nextToken();
+    }
+    lazyBodies = parser.lazyBodies;
+    texts[textIndex].uses += parsed.size();
+    if (texts[textIndex].uses == 0) {
+        texts[textIndex].text.reset();
+    }
+    return {std::move(parsed), synced};
+}
+
+std::uint32_t IncrementalParser::useText(const std::shared_ptr<const std::string> &text) {
+    for (std::size_t i = 0; i < texts.size(); i++) {
+        if (texts[i].text == text) {
+            return static_cast<std::uint32_t>(i);
+        }
+    }
+    for (std::size_t i = 0; i < texts.size(); i++) {
+        if (texts[i].uses == 0) {
+            texts[i].text = text;
+            return static_cast<std::uint32_t>(i);
+        }
+    }
+    texts.push_back(Text{text, 0});
+    return static_cast<std::uint32_t>(texts.size() - 1);
+}
+
+std::size_t IncrementalParser::liveTexts() const {
+    return std::ranges::count_if(texts, [](const Text &text) { return text.uses > 0; });
+}
+
+void IncrementalParser::publish() {
+    std::vector<Statement *> statements;
+    statements.reserve(entries.size());
+    for (const auto &entry: entries) {
+        if (entry.statement != nullptr) {
+            statements.push_back(entry.statement);
+        }
+    }
+    std::vector<std::shared_ptr<const std::string> > live;
+    for (const auto &text: texts) {
+        if (text.uses > 0) {
+            live.push_back(text.text);
+        }
+    }
+    latest = std::make_shared<const Program>(
+        std::move(statements), arena, std::make_shared<const std::vector<std::shared_ptr<const std::string> > >(std::move(live)),
+        symbols);
+}
@@ -0,0 +1,99 @@
+#ifndef PITAYA_INCREMENTAL_H
+#define PITAYA_INCREMENTAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "parser.h"
+
+// after this many texts are kept alive for reused statements, or the arena holds this many times the bytes of the
+// last full parse, edit() parses everything again to let go of what the old statements no longer use
+static constexpr std::size_t INCREMENTAL_MAX_TEXTS = 8;
+static constexpr std::size_t INCREMENTAL_MAX_ARENA_GROWTH = 2;
+
+// Replaces text[offset, offset + length) with replacement
+struct TextEdit {
+    std::size_t offset;
+    std::size_t length;
+    std::string replacement;
+};
+
+// Keeps a source text and its Program up to date edit by edit, for editors that reparse on every keystroke.
+// An edit re-lexes and re-parses only the top-level statements it touches: parsing starts one statement before the
+// edit, since where that one ends depends on the token after it, and stops at the first statement boundary past the
+// edit that lines up with an old one. Every other statement of the previous Program is reused as is.
+//
+// Programs of one IncrementalParser share an arena and a SymbolTable that later edits add to, so don't read an
+// earlier Program's symbols on another thread while edit() runs.
+struct IncrementalParser {
+    explicit IncrementalParser(std::string text, ParserOptions options = {});
+
+    // applies edit, which must lie within text(), and returns the updated Program
+    std::shared_ptr<const Program> edit(const TextEdit &edit);
+
+    [[nodiscard]] std::shared_ptr<const Program> program() const;
+
+    [[nodiscard]] std::string_view text() const;
+
+    // parser errors of the whole text, in source order
+    [[nodiscard]] std::vector<std::string> errors() const;
+
+    // how many top-level statements the last edit parsed; all of them after a full parse
+    [[nodiscard]] std::size_t reparsed() const;
+
+private:
+    // One turn of Parser::parseProgram's loop: where it started and what it produced, null for a failed statement.
+    // Kept trivially copyable, since an edit splices and shifts every entry after it.
+    struct Entry {
+        std::size_t start;
+        Statement *statement;
+        // into texts: the text the entry's tokens point into
+        std::uint32_t text;
+    };
+
+    struct Error {
+        // start of the entry that reported it
+        std::size_t start;
+        std::string message;
+    };
+
+    struct Text {
+        std::shared_ptr<const std::string> text;
+        // entries pointing into it; released when none are left
+        std::size_t uses;
+    };
+
+    ParserOptions options;
+    std::shared_ptr<const std::string> current;
+    std::shared_ptr<ParseArena> arena;
+    std::shared_ptr<SymbolTable> symbols;
+    // shared by every parse into arena, so bodies deferred by different edits take the same lock
+    Parser::LazyBodies *lazyBodies = nullptr;
+    std::size_t fullParseBytes = 0;
+    std::vector<Entry> entries;
+    // in source order
+    std::vector<Error> errorList;
+    std::vector<Text> texts;
+    std::shared_ptr<const Program> latest;
+    std::size_t lastReparsed = 0;
+
+    void parseAll();
+
+    // Parses current from `from` until EOF, or until reaching the start of an entry at or after `resync`, shifted by
+    // delta. Returns the new entries and the index of the entry it resynchronised on (entries.size() at EOF).
+    std::pair<std::vector<Entry>, std::size_t> parse(std::size_t from, std::size_t resync, std::ptrdiff_t delta,
+                                                     std::vector<Error> &errors);
+
+    [[nodiscard]] std::uint32_t useText(const std::shared_ptr<const std::string> &text);
+
+    [[nodiscard]] std::size_t liveTexts() const;
+
+    void publish();
+};
+
+#endif //PITAYA_INCREMENTAL_H
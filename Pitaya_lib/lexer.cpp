@@ -1,100 +1,163 @@
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <utility>
 #include "tokens.h"
 #include "lexer.h"
-
-#include <algorithm>
+#include "scanner.h"
 
 namespace LexerUtil {
-    bool is_identifier(const char c) {
-        return std::isalpha(c) || c == '_';
-    }
+    // What nextToken does with the current character
+    enum struct Action : std::uint8_t {
+        ILLEGAL,
+        SINGLE,
+        ENDS_WITH_EQUAL,
+        STRING,
+        IDENTIFIER,
+        NUMBER,
+        END,
+    };
+
+    struct Dispatch {
+        Action action = Action::ILLEGAL;
+        TokenType oneChar = TokenType::ILLEGAL;
+        TokenType twoChars = TokenType::ILLEGAL;
+    };
+
+    constexpr std::array<Dispatch, 256> DISPATCH = [] {
+        std::array<Dispatch, 256> dispatch{};
+        const auto single = [&dispatch](const char c, const TokenType tokenType) {
+            dispatch[static_cast<unsigned char>(c)] = Dispatch{Action::SINGLE, tokenType};
+        };
+        single(';', TokenType::SEMICOLON);
+        single(':', TokenType::COLON);
+        single(',', TokenType::COMMA);
+        single('(', TokenType::LPAREN);
+        single(')', TokenType::RPAREN);
+        single('{', TokenType::LBRACE);
+        single('}', TokenType::RBRACE);
+        single('[', TokenType::LBRACKET);
+        single(']', TokenType::RBRACKET);
+        single('+', TokenType::PLUS);
+        single('-', TokenType::MINUS);
+        single('*', TokenType::ASTERISK);
+        single('/', TokenType::SLASH);
+        single('<', TokenType::LT);
+        single('>', TokenType::GT);
+        dispatch['='] = Dispatch{Action::ENDS_WITH_EQUAL, TokenType::ASSIGN, TokenType::EQ};
+        dispatch['!'] = Dispatch{Action::ENDS_WITH_EQUAL, TokenType::BANG, TokenType::NOT_EQ};
+        dispatch['"'] = Dispatch{Action::STRING};
+        dispatch[static_cast<unsigned char>(ZERO)] = Dispatch{Action::END};
+        for (std::size_t c = 0; c < dispatch.size(); c++) {
+            if (Scanner::CHAR_CLASSES[c] & Scanner::LETTER) {
+                dispatch[c] = Dispatch{Action::IDENTIFIER};
+            } else if (Scanner::CHAR_CLASSES[c] & Scanner::DIGIT) {
+                dispatch[c] = Dispatch{Action::NUMBER};
+            }
+        }
+        return dispatch;
+    }();
 
     bool is_whitespace(const char c) {
-        return std::ranges::any_of(WHITESPACES,
-                                   [c](const char &whitespace) {
-                                       return whitespace == c;
-                                   });
+        return Scanner::charClass(c) & Scanner::WHITESPACE;
+    }
+
+    bool contains(const std::string_view input, const char *p) {
+        return std::less_equal<>{}(input.data(), p) && std::less<>{}(p, input.data() + input.size());
     }
 }
 
-Lexer::Lexer(std::string input) : input{std::move(input)} {
+Lexer::Lexer(std::string input) : owner{std::make_shared<const std::string>(std::move(input))},
+                                  input{*static_cast<const std::string *>(owner.get())},
+                                  scanner{&Scanner::kernels()} {
+    readChar();
+}
+
+Lexer::Lexer(const char *input) : Lexer(std::string{input}) {
+}
+
+Lexer::Lexer(const std::string_view input, std::shared_ptr<const void> owner) : owner{std::move(owner)},
+    input{input}, scanner{&Scanner::kernels()} {
     readChar();
 }
 
-Token *Lexer::nextToken() {
+std::shared_ptr<const void> Lexer::source() const {
+    return owner;
+}
+
+std::optional<std::string_view> TokenSource::skipBlock(const Token &) {
+    return std::nullopt;
+}
+
+std::optional<std::string_view> Lexer::skipBlock(const Token &open) {
+    if (open.tokenType != TokenType::LBRACE || !LexerUtil::contains(input, open.literal.data())) {
+        return std::nullopt;
+    }
+    const auto start = static_cast<std::size_t>(open.literal.data() - input.data());
+    std::size_t depth = 0;
+    for (auto i = scanner->findBlockSyntax(input, start); i < input.size(); i = scanner->findBlockSyntax(input, i + 1)) {
+        switch (input[i]) {
+            case '{':
+                depth++;
+                break;
+            case '}':
+                if (--depth == 0) {
+                    seek(i);
+                    return input.substr(start, i + 1 - start);
+                }
+                break;
+            case '"':
+                i = scanner->findStringEnd(input, i + 1);
+                if (i == input.size() || input[i] == ZERO) {
+                    return std::nullopt;
+                }
+                break;
+            default:
+                // ZERO ends the input for nextToken too
+                return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view Lexer::text() const {
+    return input;
+}
+
+Token Lexer::nextToken() {
     skipWhitespaces();
-    Token *r = nullptr;
-    switch (ch) {
-        case '=':
-            r = endsWithEqual(TokenType::ASSIGN, TokenType::EQ, true);
-            break;
-        case '!':
-            r = endsWithEqual(TokenType::BANG, TokenType::NOT_EQ, false);
-            break;
-        case ';':
-            r = token(TokenType::SEMICOLON);
-            break;
-        case ':':
-            r = token(TokenType::COLON);
-            break;
-        case ',':
-            r = token(TokenType::COMMA);
-            break;
-        case '(':
-            r = token(TokenType::LPAREN);
-            break;
-        case ')':
-            r = token(TokenType::RPAREN);
-            break;
-        case '{':
-            r = token(TokenType::LBRACE);
-            break;
-        case '}':
-            r = token(TokenType::RBRACE);
-            break;
-        case '[':
-            r = token(TokenType::LBRACKET);
-            break;
-        case ']':
-            r = token(TokenType::RBRACKET);
-            break;
-        case '+':
-            r = token(TokenType::PLUS);
-            break;
-        case '-':
-            r = token(TokenType::MINUS);
-            break;
-        case '*':
-            r = token(TokenType::ASTERISK);
-            break;
-        case '/':
-            r = token(TokenType::SLASH);
-            break;
-        case '<':
-            r = token(TokenType::LT);
-            break;
-        case '>':
-            r = token(TokenType::GT);
-            break;
-        case ZERO:
-            r = new Token(TokenType::EOF_, "");
-            break;
-        case '"':
-            r = new Token(TokenType::STRING, readString());
-            break;
-        default:
-            if (LexerUtil::is_identifier(ch)) {
-                const auto identifier = readIdentifier();
-                return new Token(lookupIdent(identifier), identifier);
-            }
-            if (isdigit(ch)) {
-                return new Token(TokenType::INT, readNumber());
-            }
-            return new Token(TokenType::ILLEGAL, ch);
+    switch (const auto &[action, oneChar, twoChars] = LexerUtil::DISPATCH[static_cast<unsigned char>(ch)]; action) {
+        case LexerUtil::Action::IDENTIFIER: {
+            const auto identifier = readIdentifier();
+            return Token{lookupIdent(identifier), identifier};
+        }
+        case LexerUtil::Action::NUMBER:
+            return integer(readNumber());
+        case LexerUtil::Action::END:
+            return Token{TokenType::EOF_, ""};
+        case LexerUtil::Action::STRING: {
+            const auto r = Token{TokenType::STRING, readString()};
+            readChar();
+            return r;
+        }
+        case LexerUtil::Action::ENDS_WITH_EQUAL: {
+            const auto r = endsWithEqual(oneChar, twoChars);
+            readChar();
+            return r;
+        }
+        case LexerUtil::Action::SINGLE: {
+            const auto r = token(oneChar);
+            readChar();
+            return r;
+        }
+        default: {
+            const auto r = token(TokenType::ILLEGAL);
+            readChar();
+            return r;
+        }
     }
-    readChar();
-    return r;
 }
 
 
@@ -111,33 +174,40 @@ void Lexer::readChar() {
     return input[readPosition];
 }
 
-std::string Lexer::readNumber() {
-    return readValue([](const char c) { return std::isdigit(c); });
+std::string_view Lexer::readNumber() {
+    return readValue(scanner->skipDigits);
 }
 
-std::string Lexer::readIdentifier() {
-    return readValue([](const char c) { return LexerUtil::is_identifier(c); });
+std::string_view Lexer::readIdentifier() {
+    return readValue(scanner->skipIdentifier);
 }
 
-std::string Lexer::readString() {
+std::string_view Lexer::readString() {
     const auto start = position + 1;
-    while (true) {
-        readChar();
-        if (ch == '"' || ch == ZERO) {
-            break;
-        }
-    }
+    seek(scanner->findStringEnd(input, start));
     return input.substr(start, position - start);
 }
 
 void Lexer::skipWhitespaces() {
-    while (LexerUtil::is_whitespace(ch)) {
+    if (!LexerUtil::is_whitespace(ch)) {
+        return;
+    }
+    // most runs are a single space or newline, not worth a scanner call
+    if (!LexerUtil::is_whitespace(peakChar())) {
         readChar();
+        return;
     }
+    seek(scanner->skipWhitespace(input, position));
+}
+
+void Lexer::seek(const std::size_t newPosition) {
+    position = newPosition;
+    readPosition = position;
+    readChar();
 }
 
-Token *Lexer::token(const TokenType tokenType) const {
-    return new Token(tokenType, ch);
+Token Lexer::token(const TokenType tokenType) const {
+    return Token{tokenType, input.substr(position, 1)};
 }
 
 char Lexer::peakChar() {
@@ -147,23 +217,24 @@ char Lexer::peakChar() {
     return input[readPosition];
 }
 
-Token *Lexer::endsWithEqual(const TokenType oneChar, const TokenType twoChars, const bool duplicateChars) {
+Token Lexer::integer(const std::string_view digits) {
+    // only digits reach here, so the one way for from_chars to fail is a value out of range
+    long value = 0;
+    const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    return error == std::errc{} ? Token{TokenType::INT, digits, value, true} : Token{TokenType::INT, digits, 0, false};
+}
+
+Token Lexer::endsWithEqual(const TokenType oneChar, const TokenType twoChars) {
     if (peakChar() == '=') {
-        const auto currentChar = ch;
+        const auto start = position;
         readChar();
-        if (duplicateChars) {
-            return new Token(twoChars, std::string{currentChar, currentChar});
-        }
-        return new Token(twoChars, std::string{currentChar, ch});
+        return Token{twoChars, input.substr(start, 2)};
     }
     return token(oneChar);
 }
 
-template<typename Fn>
-std::string Lexer::readValue(Fn predicate) {
+std::string_view Lexer::readValue(std::size_t (*scan)(std::string_view, std::size_t)) {
     const auto currentPosition = position;
-    while (predicate(ch)) {
-        readChar();
-    }
+    seek(scan(input, position));
     return input.substr(currentPosition, position - currentPosition);
 }
@@ -4,41 +4,85 @@
 
 #ifndef PITAYA_LEXER_H
 #define PITAYA_LEXER_H
+#include <memory>
+#include <optional>
+#include <string>
+
 #include "tokens.h"
+
+namespace Scanner {
+    struct ScanKernels;
+}
+
 static constexpr char ZERO = 0;
 static constexpr auto WHITESPACES = {' ', '\t', '\r', '\n'};
 
-struct Lexer {
+// Where the Parser pulls its tokens from
+struct TokenSource {
+    virtual ~TokenSource() = default;
+
+    virtual Token nextToken() = 0;
+
+    // keeps alive the text every token literal points into; whoever keeps tokens around must hold on to it
+    [[nodiscard]] virtual std::shared_ptr<const void> source() const = 0;
+
+    // Jumps past the block opened by `open`, a '{' already returned, without producing the tokens inside it: the next
+    // token is the block's closing '}'. Returns the block's text from '{' to '}', or nullopt, leaving the source where
+    // it was, when the block isn't closed or the source can't skip.
+    virtual std::optional<std::string_view> skipBlock(const Token &open);
+};
+
+struct Lexer final : TokenSource {
     explicit Lexer(std::string input);
 
-    Token *nextToken();
+    explicit Lexer(const char *input);
+
+    // Lexes input in place without copying it. owner, if any, is what keeps input alive (a string, a MappedFile...)
+    // and is handed on to the tokens' consumers through source(); without one the caller must keep input alive.
+    explicit Lexer(std::string_view input, std::shared_ptr<const void> owner = nullptr);
+
+    Token nextToken() override;
+
+    [[nodiscard]] std::shared_ptr<const void> source() const override;
+
+    // matches braces on the raw text, stepping over string literals whole
+    std::optional<std::string_view> skipBlock(const Token &open) override;
+
+    // the whole input being lexed
+    [[nodiscard]] std::string_view text() const;
+
+    // the INT token for a run of digits, with its value decoded
+    [[nodiscard]] static Token integer(std::string_view digits);
 
 private:
-    const std::string input;
-    int position = 0;
-    int readPosition = 0;
+    std::shared_ptr<const void> owner;
+    std::string_view input;
+    const Scanner::ScanKernels *scanner;
+    std::size_t position = 0;
+    std::size_t readPosition = 0;
     char ch = ZERO;
 
     void readChar();
 
     [[nodiscard]] char peakChar() const;
 
-    template<typename Fn>
-    std::string readValue(Fn predicate);
+    void seek(std::size_t newPosition);
+
+    std::string_view readValue(std::size_t (*scan)(std::string_view, std::size_t));
 
-    std::string readNumber();
+    std::string_view readNumber();
 
-    std::string readIdentifier();
+    std::string_view readIdentifier();
 
-    std::string readString();
+    std::string_view readString();
 
     void skipWhitespaces();
 
-    [[nodiscard]] Token *token(TokenType tokenType) const;
+    [[nodiscard]] Token token(TokenType tokenType) const;
 
     char peakChar();
 
-    Token *endsWithEqual(TokenType oneChar, TokenType twoChars, bool duplicateChars);
+    Token endsWithEqual(TokenType oneChar, TokenType twoChars);
 };
 
 
@@ -0,0 +1,67 @@
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace MappedFileUtil {
+    [[noreturn]] void fail(const std::string &what, const std::string &path) {
+        throw std::system_error{errno, std::generic_category(), what + " " + path};
+    }
+
+    // closes the descriptor on every way out of open(); the mapping stays valid without it
+    struct Descriptor {
+        int fd;
+
+        ~Descriptor() {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    };
+}
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string &path) {
+    const MappedFileUtil::Descriptor descriptor{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (descriptor.fd < 0) {
+        MappedFileUtil::fail("open", path);
+    }
+    struct stat status{};
+    if (::fstat(descriptor.fd, &status) != 0) {
+        MappedFileUtil::fail("stat", path);
+    }
+    const auto size = static_cast<std::size_t>(status.st_size);
+    // mmap refuses empty mappings, and an empty file needs none
+    if (size == 0) {
+        return std::shared_ptr<const MappedFile>{new MappedFile{nullptr, 0}};
+    }
+    const auto address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor.fd, 0);
+    if (address == MAP_FAILED) {
+        MappedFileUtil::fail("mmap", path);
+    }
+    // the lexer reads front to back
+    ::madvise(address, size, MADV_SEQUENTIAL);
+    return std::shared_ptr<const MappedFile>{new MappedFile{address, size}};
+}
+
+MappedFile::MappedFile(void *address, const std::size_t size) : address{address}, size{size} {
+}
+
+MappedFile::~MappedFile() {
+    if (address != nullptr) {
+        ::munmap(address, size);
+    }
+}
+
+std::string_view MappedFile::text() const {
+    return size == 0 ? std::string_view{} : std::string_view{static_cast<const char *>(address), size};
+}
+
+Lexer lexFile(const std::string &path) {
+    const auto file = MappedFile::open(path);
+    return Lexer{file->text(), file};
+}
@@ -0,0 +1,35 @@
+#ifndef PITAYA_MAPPED_FILE_H
+#define PITAYA_MAPPED_FILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "lexer.h"
+
+// A file mapped read-only into memory, unmapped when the last reference goes away. Hand the shared_ptr to the Lexer
+// as the owner of the text, and every token, Program and TokenBuffer built from it keeps the mapping alive.
+struct MappedFile {
+    // throws std::system_error when the file can't be opened or mapped
+    static std::shared_ptr<const MappedFile> open(const std::string &path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] std::string_view text() const;
+
+private:
+    MappedFile(void *address, std::size_t size);
+
+    void *address;
+    std::size_t size;
+};
+
+// Lexes a file in place, straight out of its mapping
+Lexer lexFile(const std::string &path);
+
+#endif //PITAYA_MAPPED_FILE_H
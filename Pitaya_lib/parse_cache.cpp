@@ -0,0 +1,112 @@
+#include "parse_cache.h"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+namespace ParseCacheUtil {
+    // a parse takes a few dozen arena bytes per source byte and interns at most as many bytes as the source has
+    constexpr std::size_t ARENA_BYTES_PER_SOURCE_BYTE = 32;
+    constexpr std::size_t MINIMUM_ARENA_CHUNK_SIZE = 512;
+    constexpr std::size_t MINIMUM_SYMBOL_CHUNK_SIZE = 64;
+
+    std::size_t chunkSize(const std::size_t bytes, const std::size_t minimum, const std::size_t maximum) {
+        return std::clamp(std::bit_ceil(std::max<std::size_t>(bytes, 1)), minimum, maximum);
+    }
+}
+
+ParseCache::ParseCache(const std::size_t byteBudget, const ParserOptions options) : byteBudget{byteBudget},
+    options{options} {
+}
+
+std::shared_ptr<const CachedParse> ParseCache::parse(const std::string_view source) {
+    const auto hash = std::hash<std::string_view>{}(source);
+    {
+        std::scoped_lock lock{mutex};
+        if (auto cached = find(hash, source); cached != nullptr) {
+            hits++;
+            return cached;
+        }
+        misses++;
+    }
+
+    auto text = std::make_shared<const std::string>(source);
+    Parser parser{
+        Lexer{*text, text}, options,
+        std::make_shared<ParseArena>(ParseCacheUtil::chunkSize(
+            text->size() * ParseCacheUtil::ARENA_BYTES_PER_SOURCE_BYTE, ParseCacheUtil::MINIMUM_ARENA_CHUNK_SIZE,
+            DEFAULT_ARENA_CHUNK_SIZE)),
+        std::make_shared<SymbolTable>(ParseCacheUtil::chunkSize(
+            text->size(), ParseCacheUtil::MINIMUM_SYMBOL_CHUNK_SIZE, DEFAULT_SYMBOL_CHUNK_SIZE))
+    };
+    std::shared_ptr<const Program> program{parser.parseProgram()};
+    std::size_t size = text->size() + sizeof(Program) + program->statements.capacity() * sizeof(Statement *);
+    if (program->arena != nullptr) {
+        size += program->arena->bytesReserved();
+    }
+    if (program->symbols != nullptr) {
+        size += program->symbols->bytesReserved();
+    }
+    for (const auto &error: parser.errors) {
+        size += error.size();
+    }
+    auto parse = std::make_shared<const CachedParse>(std::move(program), std::move(parser.errors), size);
+
+    std::scoped_lock lock{mutex};
+    // another thread got there first
+    if (auto cached = find(hash, source); cached != nullptr) {
+        return cached;
+    }
+    if (size > byteBudget) {
+        return parse;
+    }
+    entries.push_front(Entry{hash, std::move(text), parse});
+    index.emplace(hash, entries.begin());
+    bytes += size;
+    evict();
+    return parse;
+}
+
+ParseCacheStats ParseCache::stats() const {
+    std::scoped_lock lock{mutex};
+    return ParseCacheStats{hits, misses, evictions, entries.size(), bytes};
+}
+
+void ParseCache::clear() {
+    std::scoped_lock lock{mutex};
+    entries.clear();
+    index.clear();
+    bytes = 0;
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+}
+
+std::shared_ptr<const CachedParse> ParseCache::find(const std::size_t hash, const std::string_view source) {
+    const auto [first, last] = index.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (*it->second->source == source) {
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->parse;
+        }
+    }
+    return nullptr;
+}
+
+void ParseCache::evict() {
+    while (bytes > byteBudget) {
+        const auto &oldest = entries.back();
+        const auto [first, last] = index.equal_range(oldest.hash);
+        for (auto it = first; it != last; ++it) {
+            if (it->second == std::prev(entries.end())) {
+                index.erase(it);
+                break;
+            }
+        }
+        bytes -= oldest.parse->bytes;
+        entries.pop_back();
+        evictions++;
+    }
+}
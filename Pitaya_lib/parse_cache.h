@@ -0,0 +1,77 @@
+#ifndef PITAYA_PARSE_CACHE_H
+#define PITAYA_PARSE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "parser.h"
+
+// One parse of a source text, shared by every caller that asks for the same text
+struct CachedParse {
+    std::shared_ptr<const Program> program;
+    std::vector<std::string> errors;
+    // what the entry is charged against the cache's budget
+    std::size_t bytes;
+};
+
+struct ParseCacheStats {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t evictions;
+    std::size_t entries;
+    std::size_t bytes;
+};
+
+// Thread-safe LRU cache of parsed sources, keyed by a hash of the text and checked against the text itself, so a
+// hash collision is only ever a miss. An entry is charged the memory its Program holds: every chunk of its arena and
+// symbol table, used or not, and its source text. Sources are parsed into chunks sized from their length, so a short
+// snippet doesn't pin a full-sized arena chunk. Once the total goes over byteBudget, the least recently used entries
+// are dropped. A Program that doesn't fit in the budget on its own is returned but not kept. With lazyFunctionBodies,
+// bodies parsed after the Program was cached aren't charged.
+//
+// Sources are parsed outside the lock, so threads missing on the same text at once each parse it, and all but the
+// first of them to finish get the first one's result.
+struct ParseCache {
+    explicit ParseCache(std::size_t byteBudget, ParserOptions options = {});
+
+    // the parse of source, from the cache or parsed now
+    std::shared_ptr<const CachedParse> parse(std::string_view source);
+
+    [[nodiscard]] ParseCacheStats stats() const;
+
+    // drops every entry and zeroes the hit, miss and eviction counts
+    void clear();
+
+private:
+    struct Entry {
+        std::size_t hash;
+        std::shared_ptr<const std::string> source;
+        std::shared_ptr<const CachedParse> parse;
+    };
+
+    const std::size_t byteBudget;
+    const ParserOptions options;
+    mutable std::mutex mutex;
+    // most recently used first
+    std::list<Entry> entries;
+    std::unordered_multimap<std::size_t, std::list<Entry>::iterator> index;
+    std::size_t bytes = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+
+    // with mutex held
+    std::shared_ptr<const CachedParse> find(std::size_t hash, std::string_view source);
+
+    // with mutex held
+    void evict();
+};
+
+#endif //PITAYA_PARSE_CACHE_H
@@ -1,35 +1,254 @@
 #include "parser.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <sstream>
+#include <type_traits>
 #include <utility>
 
 namespace ParserUtils {
-    const auto INVALID = new Token(TokenType::ILLEGAL, '_');
+    constexpr auto INVALID = Token{TokenType::ILLEGAL, "_"};
+    constexpr std::size_t EXPRESSION_LIST_RESERVE = 4;
+
+    std::unique_ptr<TokenSource> tokenSource(Lexer lexer, const ParserOptions &options) {
+        // a buffer can't index past MAX_TOKEN_BUFFER_INPUT, longer inputs are lexed on demand instead
+        if (options.preLex && lexer.text().size() <= MAX_TOKEN_BUFFER_INPUT) {
+            return std::make_unique<TokenCursor>(options.lexThreads == 1
+                                                     ? TokenBuffer::lex(std::move(lexer))
+                                                     : TokenBuffer::lexParallel(lexer, options.lexThreads));
+        }
+        if (options.pipelined) {
+            return std::make_unique<PipelinedLexer>(std::move(lexer));
+        }
+        return std::make_unique<Lexer>(std::move(lexer));
+    }
+
+    // counts a call for as long as it runs
+    struct Nesting {
+        explicit Nesting(std::size_t &depth) : depth{depth} {
+            ++depth;
+        }
+
+        ~Nesting() {
+            --depth;
+        }
+
+        Nesting(const Nesting &) = delete;
+
+        Nesting &operator=(const Nesting &) = delete;
+
+    private:
+        std::size_t &depth;
+    };
+}
+
+Parser::Parser(Lexer lexer, const ParserOptions options) : Parser(
+    ParserUtils::tokenSource(std::move(lexer), options), options) {
 }
 
-Parser::Parser(Lexer lexer) : lexer{std::move(lexer)}, curToken(ParserUtils::INVALID), peekToken(ParserUtils::INVALID) {
+Parser::Parser(TokenBuffer tokens, const ParserOptions options) : Parser(
+    std::make_unique<TokenCursor>(std::move(tokens)), options) {
+}
+
+Parser::Parser(std::unique_ptr<TokenSource> tokens, const ParserOptions options) : Parser(
+    std::move(tokens), options, std::make_shared<ParseArena>(), std::make_shared<SymbolTable>()) {
+}
+
+Parser::Parser(std::unique_ptr<TokenSource> tokens, const ParserOptions options, std::shared_ptr<ParseArena> arena,
+               std::shared_ptr<SymbolTable> symbols) : tokens{std::move(tokens)},
+                                                       options{options},
+                                                       arena{std::move(arena)},
+                                                       symbols{std::move(symbols)},
+                                                       curToken(ParserUtils::INVALID),
+    peekToken(ParserUtils::INVALID) {
     nextToken();
     nextToken();
 }
 
+Parser::Parser(Lexer lexer, const ParserOptions options, std::shared_ptr<ParseArena> arena,
+               std::shared_ptr<SymbolTable> symbols) : Parser(ParserUtils::tokenSource(std::move(lexer), options),
+                                                              options, std::move(arena), std::move(symbols)) {
+}
+
+struct Parser::LazyBodies {
+    LazyBodies(ParseArena *arena, SymbolTable *symbols, const ParserOptions &options) : arena{arena},
+        symbols{symbols}, options{options} {
+    }
+
+    // owned by the Program, which outlives every body in it
+    ParseArena *const arena;
+    SymbolTable *const symbols;
+    const ParserOptions options;
+    // bodies are parsed one at a time since they all allocate from the same arena
+    std::mutex mutex;
+    std::vector<std::pair<const LazyBody *, std::string> > errors;
+};
+
+struct Parser::LazyBody final : DeferredBody {
+    LazyBody(const std::string_view text, LazyBodies *bodies, const std::size_t depth) : text{text}, bodies{bodies},
+        depth{depth} {
+    }
+
+    BlockStatement *parse() const override {
+        if (const auto parsed = std::atomic_ref{block}.load(std::memory_order_acquire); parsed != nullptr) {
+            return parsed;
+        }
+        std::lock_guard lock{bodies->mutex};
+        if (const auto parsed = std::atomic_ref{block}.load(std::memory_order_relaxed); parsed != nullptr) {
+            return parsed;
+        }
+        // non-owning handles: a sub-parser doesn't keep the arena or the symbols alive, the Program does
+        Parser parser{
+            std::make_unique<Lexer>(text), bodies->options,
+            std::shared_ptr<ParseArena>{std::shared_ptr<void>{}, bodies->arena},
+            std::shared_ptr<SymbolTable>{std::shared_ptr<void>{}, bodies->symbols}
+        };
+        parser.lazyBodies = bodies;
+        parser.depthBase = depth;
+        const auto parsed = parser.parseBlockStatement();
+        for (auto &error: parser.errors) {
+            bodies->errors.emplace_back(this, std::move(error));
+        }
+        std::atomic_ref{block}.store(parsed, std::memory_order_release);
+        return parsed;
+    }
+
+    bool parsed() const override {
+        return std::atomic_ref{block}.load(std::memory_order_acquire) != nullptr;
+    }
+
+    std::vector<std::string> errors() const override {
+        std::lock_guard lock{bodies->mutex};
+        std::vector<std::string> found;
+        for (const auto &[body, error]: bodies->errors) {
+            if (body == this) {
+                found.push_back(error);
+            }
+        }
+        return found;
+    }
+
+private:
+    // from '{' to '}', inside the text the Program keeps alive
+    const std::string_view text;
+    LazyBodies *const bodies;
+    // how deep the function was found, which the body's own nesting adds to
+    const std::size_t depth;
+    mutable BlockStatement *block = nullptr;
+};
+
+std::unique_lock<std::mutex> Parser::lockLazyBodies() const {
+    return lazyBodies != nullptr ? std::unique_lock{lazyBodies->mutex} : std::unique_lock<std::mutex>{};
+}
+
 Program *Parser::parseProgram() {
     auto statements = std::vector<Statement *>{};
-    while (curToken->tokenType != TokenType::EOF_) {
+    while (curToken.tokenType != TokenType::EOF_) {
         if (auto statement = parseStatement(); statement.has_value()) {
             statements.push_back(statement.value());
         }
         nextToken();
     }
-    return new Program{statements};
+    return new Program{std::move(statements), arena, tokens->source(), symbols};
 }
 
 void Parser::nextToken() {
     curToken = peekToken;
-    peekToken = lexer.nextToken();
+    peekToken = tokens->nextToken();
+}
+
+template<typename T, typename... Args>
+Statement *Parser::make(Args &&... args) {
+    if (!options.hashConsing) {
+        return arena->make<T>(std::forward<Args>(args)...);
+    }
+    T candidate{std::forward<Args>(args)...};
+    if (!shareable(candidate)) {
+        return arena->make<T>(std::move(candidate));
+    }
+    if (const auto found = sharedNodes.find(&candidate); found != sharedNodes.end()) {
+        return *found;
+    }
+    const auto node = arena->make<T>(std::move(candidate));
+    sharedNodes.insert(node);
+    sharedAddresses.insert(node);
+    return node;
+}
+
+// Only nodes whose children are shared themselves can be shared: anything holding a function literal, block or a
+// subtree with parse errors keeps its own copy
+bool Parser::shareable(const Statement &node) const {
+    switch (node.kind()) {
+        case NodeKind::IDENTIFIER:
+        case NodeKind::STRING_LITERAL:
+        case NodeKind::INTEGER_LITERAL:
+        case NodeKind::BOOLEAN_LITERAL:
+            return true;
+        case NodeKind::PREFIX_EXPRESSION:
+            return isShared(static_cast<const PrefixExpression &>(node).right);
+        case NodeKind::INFIX_EXPRESSION: {
+            const auto &infix = static_cast<const InfixExpression &>(node);
+            return isShared(infix.left) && isShared(infix.right);
+        }
+        case NodeKind::INDEX_EXPRESSION: {
+            const auto &index = static_cast<const IndexExpression &>(node);
+            return isShared(index.left) && isShared(index.index);
+        }
+        case NodeKind::CALL_EXPRESSION: {
+            const auto &call = static_cast<const CallExpression &>(node);
+            return isShared(call.function) && call.arguments.has_value() &&
+                   std::ranges::all_of(call.arguments.value(), [this](const auto a) { return isShared(a); });
+        }
+        case NodeKind::ARRAY_LITERAL: {
+            const auto &array = static_cast<const ArrayLiteral &>(node);
+            return array.elements.has_value() &&
+                   std::ranges::all_of(array.elements.value(), [this](const auto e) { return isShared(e); });
+        }
+        case NodeKind::HASH_LITERAL:
+            return std::ranges::all_of(static_cast<const HashLiteral &>(node).pairs, [this](const auto &pair) {
+                return isShared(pair.first) && isShared(pair.second);
+            });
+        default:
+            return false;
+    }
+}
+
+bool Parser::isShared(const std::optional<Statement *> node) const {
+    return node.has_value() && sharedAddresses.contains(node.value());
+}
+
+bool Parser::deeperThanAllowed(const std::size_t levels) const {
+    return options.maxDepth != 0 && depthBase + levels > options.maxDepth;
+}
+
+void Parser::abandon() {
+    if (tooDeep) {
+        return;
+    }
+    std::stringstream stream;
+    stream << "nesting deeper than " << options.maxDepth << " levels";
+    errors.push_back(stream.str());
+    tooDeep = true;
+    // every parse function under way unwinds at EOF
+    while (!curTokenIs(TokenType::EOF_)) {
+        nextToken();
+    }
+}
+
+void Parser::addError(std::string message) {
+    if (!tooDeep) {
+        errors.push_back(std::move(message));
+    }
 }
 
 std::optional<Statement *> Parser::parseStatement() {
-    switch (curToken->tokenType) {
+    const ParserUtils::Nesting nesting{depth};
+    if (deeperThanAllowed(depth)) {
+        abandon();
+        return std::nullopt;
+    }
+    switch (curToken.tokenType) {
         case TokenType::LET:
             return parseLetStatement();
         case TokenType::RETURN:
@@ -44,7 +263,8 @@ std::optional<Statement *> Parser::parseLetStatement() {
     if (!expectPeek(TokenType::IDENT)) {
         return std::nullopt;
     }
-    const auto name = new Identifier(*curToken, curToken->literal);
+    const auto nameToken = curToken;
+    const auto name = symbols->intern(curToken.literal);
     if (!expectPeek(TokenType::ASSIGN)) {
         return std::nullopt;
     }
@@ -54,7 +274,7 @@ std::optional<Statement *> Parser::parseLetStatement() {
     if (peekTokenIs(TokenType::SEMICOLON)) {
         nextToken();
     }
-    return std::optional{new LetStatement(*token, *name, value)};
+    return std::optional{arena->make<LetStatement>(token, Identifier{nameToken, name}, value)};
 }
 
 std::optional<Statement *> Parser::parseReturnStatement() {
@@ -64,7 +284,7 @@ std::optional<Statement *> Parser::parseReturnStatement() {
     while (peekTokenIs(TokenType::SEMICOLON)) {
         nextToken();
     }
-    return std::optional{new ReturnStatement(*token, returnValue)};
+    return std::optional{arena->make<ReturnStatement>(token, returnValue)};
 }
 
 std::optional<Statement *> Parser::parseExpressionStatement() {
@@ -73,11 +293,11 @@ std::optional<Statement *> Parser::parseExpressionStatement() {
     if (peekTokenIs(TokenType::SEMICOLON)) {
         nextToken();
     }
-    return std::optional{new ExpressionStatement(*token, expression)};
+    return std::optional{arena->make<ExpressionStatement>(token, expression)};
 }
 
 bool Parser::peekTokenIs(const TokenType tt) const {
-    return peekToken->tokenType == tt;
+    return peekToken.tokenType == tt;
 }
 
 bool Parser::expectPeek(const TokenType tt) {
@@ -92,127 +312,170 @@ bool Parser::expectPeek(const TokenType tt) {
 
 void Parser::peekError(const TokenType tt) {
     std::stringstream stream;
-    stream << "Expected next token to be " << to_string(tt) << ", got " << to_string(peekToken->tokenType) <<
+    stream << "Expected next token to be " << to_string(tt) << ", got " << to_string(peekToken.tokenType) <<
             " instead";
-    errors.push_back(stream.str());
+    addError(stream.str());
 }
 
 bool Parser::curTokenIs(const TokenType tt) const {
-    return tt == curToken->tokenType;
+    return tt == curToken.tokenType;
+}
+
+constexpr std::array<Parser::ParseRule, TOKEN_TYPE_COUNT> Parser::RULES = [] {
+    std::array<ParseRule, TOKEN_TYPE_COUNT> rules{};
+    const auto prefix = [&rules](const TokenType tt, const PrefixParseFn parser) {
+        rules[static_cast<std::size_t>(tt)].prefix = parser;
+    };
+    const auto infix = [&rules](const TokenType tt, const InfixParseFn parser, const Precedence precedence) {
+        rules[static_cast<std::size_t>(tt)].infix = parser;
+        rules[static_cast<std::size_t>(tt)].precedence = precedence;
+    };
+    prefix(TokenType::INT, &Parser::parseIntegerLiteral);
+    prefix(TokenType::IDENT, &Parser::parseIdentifier);
+    prefix(TokenType::TRUE, &Parser::parseBooleanLiteral);
+    prefix(TokenType::FALSE, &Parser::parseBooleanLiteral);
+    prefix(TokenType::BANG, &Parser::parsePrefixExpression);
+    prefix(TokenType::MINUS, &Parser::parsePrefixExpression);
+    prefix(TokenType::LPAREN, &Parser::parseGroupExpression);
+    prefix(TokenType::LBRACKET, &Parser::parseArrayLiteral);
+    prefix(TokenType::IF, &Parser::parseIfExpression);
+    prefix(TokenType::FUNCTION, &Parser::parseFunctionLiteral);
+    prefix(TokenType::STRING, &Parser::parseStringLiteral);
+    prefix(TokenType::LBRACE, &Parser::parseHashLiteral);
+    infix(TokenType::EQ, &Parser::parseInfixExpression, Precedence::EQUALS);
+    infix(TokenType::NOT_EQ, &Parser::parseInfixExpression, Precedence::EQUALS);
+    infix(TokenType::LT, &Parser::parseInfixExpression, Precedence::LESS_GREATER);
+    infix(TokenType::GT, &Parser::parseInfixExpression, Precedence::LESS_GREATER);
+    infix(TokenType::PLUS, &Parser::parseInfixExpression, Precedence::SUM);
+    infix(TokenType::MINUS, &Parser::parseInfixExpression, Precedence::SUM);
+    infix(TokenType::SLASH, &Parser::parseInfixExpression, Precedence::PRODUCT);
+    infix(TokenType::ASTERISK, &Parser::parseInfixExpression, Precedence::PRODUCT);
+    infix(TokenType::LPAREN, &Parser::parseCallExpression, Precedence::CALL);
+    infix(TokenType::LBRACKET, &Parser::parseIndexExpression, Precedence::INDEX);
+    return rules;
+}();
+
+const Parser::ParseRule &Parser::rule(const TokenType tt) {
+    return RULES[static_cast<std::size_t>(tt)];
 }
 
 std::optional<Statement *> Parser::parseExpression(const Precedence precedence) {
-    const auto prefix = prefixParser(curToken->tokenType);
-    if (!prefix.has_value()) {
-        noPrefixParserError(curToken->tokenType);
+    const ParserUtils::Nesting nesting{depth};
+    if (deeperThanAllowed(depth)) {
+        abandon();
         return std::nullopt;
     }
-    auto left = prefix.value()(this);
+    if (options.explicitStack) {
+        return parseExpressionIteratively(precedence);
+    }
+    const auto prefix = rule(curToken.tokenType).prefix;
+    if (prefix == nullptr) {
+        noPrefixParserError(curToken.tokenType);
+        return std::nullopt;
+    }
+    auto left = (this->*prefix)();
     while (!peekTokenIs(TokenType::SEMICOLON) && precedence < peekPrecedence()) {
-        const auto infix = infixParser(peekToken->tokenType);
-        if (!infix.has_value()) {
+        const auto infix = rule(peekToken.tokenType).infix;
+        if (infix == nullptr) {
             return left;
         }
         nextToken();
-        left.emplace(infix.value()(this, left).value());
+        left = (this->*infix)(left);
     }
     return left;
 }
 
-
-std::optional<PREFIX_FN_TYPE > Parser::prefixParser(const TokenType tt) {
-    switch (tt) {
-        case TokenType::INT:
-            return std::optional{static_cast<PREFIX_FN_TYPE>(&Parser::parseIntegerLiteral)};
-        case TokenType::IDENT:
-            return std::optional{static_cast<PREFIX_FN_TYPE>(&Parser::parseIdentifier)};
-        case TokenType::TRUE:
-        case TokenType::FALSE:
-            return std::optional{static_cast<PREFIX_FN_TYPE>(&Parser::parseBooleanLiteral)};
-        case TokenType::BANG:
-        case TokenType::MINUS:
-            return std::optional{static_cast<PREFIX_FN_TYPE>(&Parser::parsePrefixExpression)};
-        case TokenType::LPAREN:
-            return std::optional{static_cast<PREFIX_FN_TYPE>(&Parser::parseGroupExpression)};
-        case TokenType::LBRACKET:
-            return std::optional{static_cast<PREFIX_FN_TYPE>(&Parser::parseArrayLiteral)};
-        case TokenType::IF:
-            return std::optional{static_cast<PREFIX_FN_TYPE>(&Parser::parseIfExpression)};
-        case TokenType::FUNCTION:
-            return std::optional{static_cast<PREFIX_FN_TYPE>(&Parser::parseFunctionLiteral)};
-        case TokenType::STRING:
-            return std::optional{static_cast<PREFIX_FN_TYPE>(&Parser::parseStringLiteral)};
-        case TokenType::LBRACE:
-            return std::optional{static_cast<PREFIX_FN_TYPE>(&Parser::parseHashLiteral)};
-        default:
-            return std::nullopt;
-    }
-}
-
-std::optional<INFIX_FN_TYPE > Parser::infixParser(const TokenType tt) {
-    switch (tt) {
-        case TokenType::PLUS:
-        case TokenType::MINUS:
-        case TokenType::SLASH:
-        case TokenType::ASTERISK:
-        case TokenType::EQ:
-        case TokenType::NOT_EQ:
-        case TokenType::LT:
-        case TokenType::GT:
-            return std::optional{static_cast<INFIX_FN_TYPE>(&Parser::parseInfixExpression)};
-        case TokenType::LPAREN:
-            return std::optional{static_cast<INFIX_FN_TYPE>(&Parser::parseCallExpression)};
-        case TokenType::LBRACKET:
-            return std::optional{static_cast<INFIX_FN_TYPE>(&Parser::parseIndexExpression)};
-        default:
-            return std::nullopt;
+// Same grammar as parseExpression: where it would recurse into parsePrefixExpression, parseGroupExpression or
+// parseInfixExpression, this pushes a frame and parses the operand in the same loop, then reduces the frame once no
+// operator binds tighter than it.
+std::optional<Statement *> Parser::parseExpressionIteratively(const Precedence precedence) {
+    using Kind = ExpressionFrame::Kind;
+    const auto base = expressionStack.size();
+    std::optional<Statement *> left;
+    while (true) {
+        while (curTokenIs(TokenType::MINUS) || curTokenIs(TokenType::BANG) || curTokenIs(TokenType::LPAREN)) {
+            if (curTokenIs(TokenType::LPAREN)) {
+                expressionStack.push_back(ExpressionFrame{Kind::GROUP, curToken, Precedence::LOWEST, std::nullopt});
+            } else {
+                expressionStack.push_back(ExpressionFrame{Kind::PREFIX, curToken, Precedence::PREFIX, std::nullopt});
+            }
+            nextToken();
+        }
+        // like parseExpression, a missing operand ends its level without looking for operators
+        auto extend = true;
+        if (const auto prefix = rule(curToken.tokenType).prefix; prefix == nullptr) {
+            noPrefixParserError(curToken.tokenType);
+            left = std::nullopt;
+            extend = false;
+        } else {
+            left = (this->*prefix)();
+        }
+        auto operandNeeded = false;
+        while (true) {
+            const auto bound = expressionStack.size() > base ? expressionStack.back().precedence : precedence;
+            while (extend && !peekTokenIs(TokenType::SEMICOLON) && bound < peekPrecedence()) {
+                const auto infix = rule(peekToken.tokenType).infix;
+                if (infix == nullptr) {
+                    break;
+                }
+                nextToken();
+                if (infix == &Parser::parseInfixExpression) {
+                    expressionStack.push_back(ExpressionFrame{Kind::INFIX, curToken, currentPrecedence(), left});
+                    nextToken();
+                    operandNeeded = true;
+                    break;
+                }
+                left = (this->*infix)(left);
+            }
+            if (operandNeeded) {
+                break;
+            }
+            if (expressionStack.size() == base) {
+                return left;
+            }
+            const auto frame = expressionStack.back();
+            expressionStack.pop_back();
+            switch (frame.kind) {
+                case Kind::PREFIX:
+                    left = make<PrefixExpression>(frame.token, frame.token.literal, left);
+                    break;
+                case Kind::INFIX:
+                    left = make<InfixExpression>(frame.token, frame.left, frame.token.literal, left);
+                    break;
+                case Kind::GROUP:
+                    if (!expectPeek(TokenType::RPAREN)) {
+                        left = std::nullopt;
+                    }
+                    break;
+            }
+            extend = true;
+        }
     }
 }
 
 void Parser::noPrefixParserError(const TokenType tt) {
     std::stringstream stream;
     stream << "no prefix parser for " << to_string(tt) << " token type";
-    errors.push_back(stream.str());
+    addError(stream.str());
 }
 
 Precedence Parser::peekPrecedence() const {
-    return findPrecedence(peekToken->tokenType);
-}
-
-Precedence Parser::findPrecedence(const TokenType tt) {
-    switch (tt) {
-        case TokenType::EQ:
-        case TokenType::NOT_EQ:
-            return Precedence::EQUALS;
-        case TokenType::LT:
-        case TokenType::GT:
-            return Precedence::LESS_GREATER;
-        case TokenType::PLUS:
-        case TokenType::MINUS:
-            return Precedence::SUM;
-        case TokenType::SLASH:
-        case TokenType::ASTERISK:
-            return Precedence::PRODUCT;
-        case TokenType::LPAREN:
-            return Precedence::CALL;
-        case TokenType::LBRACKET:
-            return Precedence::INDEX;
-        default:
-            return Precedence::LOWEST;
-    }
+    return rule(peekToken.tokenType).precedence;
 }
 
 Precedence Parser::currentPrecedence() const {
-    return findPrecedence(curToken->tokenType);
+    return rule(curToken.tokenType).precedence;
 }
 
 std::optional<std::vector<std::optional<Statement *> > > Parser::parseExpressionList(const TokenType end) {
     auto arguments = std::vector<std::optional<Statement *> >{};
     if (peekTokenIs(end)) {
         nextToken();
-        return std::optional{arguments};
+        return std::optional{std::move(arguments)};
     }
     nextToken();
+    // most lists are short: one allocation instead of growing 1, 2, 4
+    arguments.reserve(ParserUtils::EXPRESSION_LIST_RESERVE);
     arguments.push_back(parseExpression(Precedence::LOWEST));
     while (peekTokenIs(TokenType::COMMA)) {
         nextToken();
@@ -222,10 +485,15 @@ std::optional<std::vector<std::optional<Statement *> > > Parser::parseExpression
     if (!expectPeek(end)) {
         return std::nullopt;
     }
-    return std::optional{arguments};
+    return std::optional{std::move(arguments)};
 }
 
 BlockStatement *Parser::parseBlockStatement() {
+    const ParserUtils::Nesting nesting{depth};
+    if (deeperThanAllowed(depth)) {
+        // skips the rest of the input, leaving the block empty
+        abandon();
+    }
     const auto token = curToken;
     auto statements = std::vector<std::optional<Statement *> >{};
     nextToken();
@@ -235,50 +503,54 @@ BlockStatement *Parser::parseBlockStatement() {
         }
         nextToken();
     }
-    return std::move(new BlockStatement{*token, std::optional{statements}});
+    return arena->make<BlockStatement>(token, std::optional{std::move(statements)});
 }
 
 std::optional<std::vector<Identifier *> > Parser::parseFunctionParameters() {
     auto parameters = std::vector<Identifier *>{};
     if (peekTokenIs(TokenType::RPAREN)) {
         nextToken();
-        return std::optional{parameters};
+        return std::optional{std::move(parameters)};
     }
     nextToken();
     const auto token = curToken;
-    parameters.push_back(new Identifier(*token, token->literal));
+    parameters.push_back(arena->make<Identifier>(token, symbols->intern(token.literal)));
     while (peekTokenIs(TokenType::COMMA)) {
         nextToken();
         nextToken();
         const auto inner_token = curToken;
-        parameters.push_back(new Identifier(*inner_token, inner_token->literal));
+        parameters.push_back(arena->make<Identifier>(inner_token, symbols->intern(inner_token.literal)));
     }
     if (!expectPeek(TokenType::RPAREN)) {
         return std::nullopt;
     }
-    return std::optional{parameters};
+    return std::optional{std::move(parameters)};
 }
 
-std::optional<Statement *> Parser::parseIntegerLiteral() const {
-    const auto token = curToken;
-    const long value = std::stol(token->literal);
-    return std::optional{new IntegerLiteral(*token, value)};
+std::optional<Statement *> Parser::parseIntegerLiteral() {
+    if (!curToken.inRange) {
+        std::stringstream stream;
+        stream << "could not parse " << curToken.literal << " as integer";
+        addError(stream.str());
+        return std::nullopt;
+    }
+    return std::optional{make<IntegerLiteral>(curToken, curToken.value)};
 }
 
-std::optional<Statement *> Parser::parseIdentifier() const {
-    return std::optional{new Identifier(*curToken, curToken->literal)};
+std::optional<Statement *> Parser::parseIdentifier() {
+    return std::optional{make<Identifier>(curToken, symbols->intern(curToken.literal))};
 }
 
-std::optional<Statement *> Parser::parseBooleanLiteral() const {
-    return std::optional{new BooleanLiteral(*curToken, curTokenIs(TokenType::TRUE))};
+std::optional<Statement *> Parser::parseBooleanLiteral() {
+    return std::optional{make<BooleanLiteral>(curToken, curTokenIs(TokenType::TRUE))};
 }
 
 std::optional<Statement *> Parser::parsePrefixExpression() {
     const auto token = curToken;
-    const auto op = token->literal;
+    const auto op = token.literal;
     nextToken();
     const auto right = parseExpression(Precedence::PREFIX);
-    return std::optional{new PrefixExpression(*token, op, right)};
+    return std::optional{make<PrefixExpression>(token, op, right)};
 }
 
 std::optional<Statement *> Parser::parseGroupExpression() {
@@ -292,7 +564,7 @@ std::optional<Statement *> Parser::parseGroupExpression() {
 
 std::optional<Statement *> Parser::parseArrayLiteral() {
     const auto token = curToken;
-    return std::optional{new ArrayLiteral{*token, parseExpressionList(TokenType::RBRACKET)}};
+    return std::optional{make<ArrayLiteral>(token, parseExpressionList(TokenType::RBRACKET))};
 }
 
 std::optional<Statement *> Parser::parseIfExpression() {
@@ -317,7 +589,7 @@ std::optional<Statement *> Parser::parseIfExpression() {
         }
         alternative.emplace(parseBlockStatement());
     }
-    return std::optional{new IfExpression{*token, condition, consequence, alternative}};
+    return std::optional{arena->make<IfExpression>(token, condition, consequence, alternative)};
 }
 
 std::optional<Statement *> Parser::parseFunctionLiteral() {
@@ -325,21 +597,43 @@ std::optional<Statement *> Parser::parseFunctionLiteral() {
     if (!expectPeek(TokenType::LPAREN)) {
         return std::nullopt;
     }
-    const auto parameters = parseFunctionParameters();
+    auto parameters = parseFunctionParameters();
     if (!expectPeek(TokenType::LBRACE)) {
         return std::nullopt;
     }
+    if (const auto deferred = deferBlockStatement(); deferred != nullptr) {
+        return std::optional{arena->make<FunctionLiteral>(token, std::move(parameters), deferred)};
+    }
     const auto body = parseBlockStatement();
-    return std::optional{new FunctionLiteral(*token, parameters, body)};
+    return std::optional{arena->make<FunctionLiteral>(token, std::move(parameters), body)};
+}
+
+const DeferredBody *Parser::deferBlockStatement() {
+    if (!options.lazyFunctionBodies) {
+        return nullptr;
+    }
+    const auto text = tokens->skipBlock(curToken);
+    if (!text.has_value()) {
+        return nullptr;
+    }
+    // the source resumes at the closing '}', where parseBlockStatement would have left curToken
+    peekToken = tokens->nextToken();
+    nextToken();
+    // one per function literal, so keep it free of finalizers
+    static_assert(std::is_trivially_destructible_v<LazyBody>);
+    if (lazyBodies == nullptr) {
+        lazyBodies = arena->make<LazyBodies>(arena.get(), symbols.get(), options);
+    }
+    return arena->make<LazyBody>(text.value(), lazyBodies, depthBase + depth);
 }
 
-std::optional<Statement *> Parser::parseStringLiteral() const {
-    return std::optional{new StringLiteral(*curToken, curToken->literal)};
+std::optional<Statement *> Parser::parseStringLiteral() {
+    return std::optional{make<StringLiteral>(curToken, symbols->intern(curToken.literal))};
 }
 
 std::optional<Statement *> Parser::parseHashLiteral() {
     const auto token = curToken;
-    auto pairs = std::map<Statement *, Statement *>();
+    auto pairs = std::vector<std::pair<Statement *, Statement *> >();
     while (!peekTokenIs(TokenType::RBRACE)) {
         nextToken();
         const auto key = parseExpression(Precedence::LOWEST);
@@ -349,7 +643,7 @@ std::optional<Statement *> Parser::parseHashLiteral() {
         nextToken();
         const auto value = parseExpression(Precedence::LOWEST);
         if (key.has_value() && value.has_value()) {
-            pairs[key.value()] = value.value();
+            pairs.emplace_back(key.value(), value.value());
         }
         if (!peekTokenIs(TokenType::RBRACE) && !expectPeek(TokenType::COMMA)) {
             return std::nullopt;
@@ -358,22 +652,21 @@ std::optional<Statement *> Parser::parseHashLiteral() {
     if (!expectPeek(TokenType::RBRACE)) {
         return std::nullopt;
     }
-    return std::optional{new HashLiteral{*token, pairs}};
+    return std::optional{make<HashLiteral>(token, std::move(pairs))};
 }
 
 std::optional<Statement *> Parser::parseInfixExpression(const std::optional<Statement *> left) {
     const auto token = curToken;
-    const auto op = token->literal;
+    const auto op = token.literal;
     const auto precedence = currentPrecedence();
     nextToken();
     const auto right = parseExpression(precedence);
-    return std::optional{new InfixExpression(*token, left, op, right)};
+    return std::optional{make<InfixExpression>(token, left, op, right)};
 }
 
 std::optional<Statement *> Parser::parseCallExpression(const std::optional<Statement *> left) {
     const auto token = curToken;
-    const auto arguments = parseExpressionList(TokenType::RPAREN);
-    return std::optional{new CallExpression(*token, left, arguments)};
+    return std::optional{make<CallExpression>(token, left, parseExpressionList(TokenType::RPAREN))};
 }
 
 std::optional<Statement *> Parser::parseIndexExpression(const std::optional<Statement *> left) {
@@ -383,5 +676,5 @@ std::optional<Statement *> Parser::parseIndexExpression(const std::optional<Stat
     if (!expectPeek(TokenType::RBRACKET)) {
         return std::nullopt;
     }
-    return std::optional{new IndexExpression{*token, left, index}};
+    return std::optional{make<IndexExpression>(token, left, index)};
 }
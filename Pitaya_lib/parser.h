@@ -1,31 +1,117 @@
 #ifndef PITAYA_PARSER_H
 #define PITAYA_PARSER_H
 
+#include <array>
+#include <mutex>
+#include <unordered_set>
+
 #include "ast.h"
 #include "lexer.h"
-#include "boost/function.hpp"
-#define PREFIX_FN_TYPE boost::function<std::optional<Statement *> (Parser *)>
-#define INFIX_FN_TYPE boost::function<std::optional<Statement *> (Parser *, std::optional<Statement *>)>
+#include "pipelined_lexer.h"
+#include "token_buffer.h"
+
+static constexpr std::size_t DEFAULT_MAX_DEPTH = 1000;
 
 enum struct Precedence {
     LOWEST, EQUALS, LESS_GREATER, SUM, PRODUCT, PREFIX, CALL, INDEX
 };
 
+struct ParserOptions {
+    // Hand out a single node for structurally equal expressions built only from identifiers, literals and operators,
+    // so repeated subexpressions compare equal by pointer
+    bool hashConsing = false;
+    // Lex the whole input into a TokenBuffer before parsing starts, instead of pulling tokens from the Lexer on demand.
+    // Inputs longer than MAX_TOKEN_BUFFER_INPUT are still lexed on demand.
+    bool preLex = false;
+    // With preLex, how many threads lex the buffer (0 = one per hardware thread), see TokenBuffer::lexParallel
+    std::size_t lexThreads = 1;
+    // Run the Lexer on its own thread, handing tokens over through a lock-free ring (see PipelinedLexer).
+    // Ignored with preLex.
+    bool pipelined = false;
+    // Parse prefix operators, parentheses and infix operators with a heap-allocated stack instead of recursion, so
+    // nesting depth is bounded by memory rather than by the thread's stack. Calls, indexes, literals, `if` and `fn`
+    // bodies still recurse once per level of their own brackets.
+    bool explicitStack = false;
+    // Skip over `fn` bodies, recording only the text between their braces, and parse each one the first time
+    // FunctionLiteral::body() asks for it, so functions that are never looked at cost next to nothing. Needs a Lexer or
+    // a pre-lexed buffer underneath, other sources parse bodies right away. Errors inside a skipped body are reported
+    // by FunctionLiteral::bodyErrors(), not by Parser::errors.
+    bool lazyFunctionBodies = false;
+    // How deeply the parser may recurse: one level per statement, block and operand it descends into, so prefix
+    // operators, parentheses, calls, indexes, literals and bodies count but a flat `a + b + c` chain doesn't grow with
+    // its length. Deeper input is reported as an error that ends the parse rather than overflowing the thread's
+    // stack. What explicitStack parses without recursion doesn't count. A deferred body counts from the depth its
+    // function was found at. 0 means no limit. At the default, parsing takes around a megabyte of stack.
+    std::size_t maxDepth = DEFAULT_MAX_DEPTH;
+};
+
 struct Parser {
-    explicit Parser(Lexer lexer);
+    explicit Parser(Lexer lexer, ParserOptions options = {});
+
+    explicit Parser(TokenBuffer tokens, ParserOptions options = {});
+
+    explicit Parser(std::unique_ptr<TokenSource> tokens, ParserOptions options = {});
 
     std::vector<std::string> errors;
 
     Program *parseProgram();
 
 private:
-    Lexer lexer;
+    friend struct IncrementalParser;
+    friend struct ParseCache;
+    friend struct ParserSession;
+
+    // what every body deferred by one parse shares, including the parsers that later parse them
+    struct LazyBodies;
+    struct LazyBody;
+
+    Parser(std::unique_ptr<TokenSource> tokens, ParserOptions options, std::shared_ptr<ParseArena> arena,
+           std::shared_ptr<SymbolTable> symbols);
+
+    Parser(Lexer lexer, ParserOptions options, std::shared_ptr<ParseArena> arena, std::shared_ptr<SymbolTable> symbols);
+
+    std::unique_ptr<TokenSource> tokens;
+    ParserOptions options;
+    std::shared_ptr<ParseArena> arena;
+    std::shared_ptr<SymbolTable> symbols;
+    std::unordered_set<Statement *, StatementHash, StatementEqual> sharedNodes;
+    // the same nodes by address, so telling whether a child is shared never hashes it: hashing a FunctionLiteral
+    // would parse its deferred body
+    std::unordered_set<const Statement *> sharedAddresses;
+    // created with the first deferred body
+    LazyBodies *lazyBodies = nullptr;
+
+    // levels above the text being parsed: for a deferred body, those its function was found under
+    std::size_t depthBase = 0;
+    // parseStatement(), parseBlockStatement() and parseExpression() calls under way, which is what the parser's own
+    // stack grows with
+    std::size_t depth = 0;
+    // set once maxDepth was exceeded: the rest of the input is skipped, reporting nothing more
+    bool tooDeep = false;
+
+    [[nodiscard]] bool deeperThanAllowed(std::size_t levels) const;
+
+    // reports that maxDepth was exceeded and skips to the end of the input
+    void abandon();
+
+    void addError(std::string message);
 
-    Token *curToken;
-    Token *peekToken;
+    // held while adding to an arena whose deferred bodies may be parsed on other threads
+    [[nodiscard]] std::unique_lock<std::mutex> lockLazyBodies() const;
+
+    Token curToken;
+    Token peekToken;
 
     void nextToken();
 
+    // allocates an expression node, or returns the shared node equal to it when hash-consing
+    template<typename T, typename... Args>
+    Statement *make(Args &&... args);
+
+    [[nodiscard]] bool shareable(const Statement &node) const;
+
+    [[nodiscard]] bool isShared(std::optional<Statement *> node) const;
+
     std::optional<Statement *> parseStatement();
 
     std::optional<Statement *> parseLetStatement();
@@ -42,19 +128,43 @@ private:
 
     [[nodiscard]] bool curTokenIs(TokenType tt) const;
 
-    std::optional<Statement *> parseExpression(Precedence precedence);
+    using PrefixParseFn = std::optional<Statement *> (Parser::*)();
+    using InfixParseFn = std::optional<Statement *> (Parser::*)(std::optional<Statement *>);
+
+    // How a token takes part in an expression; null parsers mean the token can't start or continue one
+    struct ParseRule {
+        PrefixParseFn prefix = nullptr;
+        InfixParseFn infix = nullptr;
+        Precedence precedence = Precedence::LOWEST;
+    };
+
+    // Pratt table indexed by TokenType
+    static const std::array<ParseRule, TOKEN_TYPE_COUNT> RULES;
 
-    std::optional<PREFIX_FN_TYPE > prefixParser(TokenType tt);
+    static const ParseRule &rule(TokenType tt);
 
-    std::optional<boost::function<std::optional<Statement *>(Parser *, std::optional<Statement *>)> >
-    infixParser(TokenType tt);
+    // An operator of parseExpressionIteratively still waiting for its right operand
+    struct ExpressionFrame {
+        enum struct Kind : std::uint8_t { PREFIX, GROUP, INFIX };
+
+        Kind kind;
+        Token token;
+        // what the operand binds to: only operators above it extend the operand before the frame is reduced
+        Precedence precedence;
+        std::optional<Statement *> left;
+    };
+
+    // shared by nested calls, each one working above the size it found on entry
+    std::vector<ExpressionFrame> expressionStack;
+
+    std::optional<Statement *> parseExpression(Precedence precedence);
+
+    std::optional<Statement *> parseExpressionIteratively(Precedence precedence);
 
     void noPrefixParserError(TokenType tt);
 
     [[nodiscard]] Precedence peekPrecedence() const;
 
-    static Precedence findPrecedence(TokenType tt);
-
     [[nodiscard]] Precedence currentPrecedence() const;
 
     std::optional<std::vector<std::optional<Statement *> > > parseExpressionList(TokenType end);
@@ -63,12 +173,15 @@ private:
 
     std::optional<std::vector<Identifier *>> parseFunctionParameters();
 
+    // skips the block at curToken when lazyFunctionBodies allows it, leaving curToken on its closing '}'
+    const DeferredBody *deferBlockStatement();
+
     // prefix parsers
-    std::optional<Statement *> parseIntegerLiteral() const;
+    std::optional<Statement *> parseIntegerLiteral();
 
-    std::optional<Statement *> parseIdentifier() const;
+    std::optional<Statement *> parseIdentifier();
 
-    std::optional<Statement *> parseBooleanLiteral() const;
+    std::optional<Statement *> parseBooleanLiteral();
 
     std::optional<Statement *> parsePrefixExpression();
 
@@ -80,7 +193,7 @@ private:
 
     std::optional<Statement *> parseFunctionLiteral();
 
-    std::optional<Statement *> parseStringLiteral() const;
+    std::optional<Statement *> parseStringLiteral();
 
     std::optional<Statement *> parseHashLiteral();
 
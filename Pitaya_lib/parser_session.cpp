@@ -0,0 +1,51 @@
+#include "parser_session.h"
+
+#include <utility>
+
+ParserSession::ParserSession(const ParserOptions options, const std::size_t retainBytes) : options{options},
+    retainBytes{retainBytes} {
+}
+
+std::shared_ptr<const Program> ParserSession::parse(const std::string_view source) {
+    if (used) {
+        recycledCount += recycle();
+    }
+    used = true;
+    text->assign(source);
+    errorList.clear();
+
+    Parser parser{Lexer{std::string_view{*text}, text}, options, arena, symbols};
+    parser.errors = std::move(errorList);
+    std::shared_ptr<const Program> program{parser.parseProgram()};
+    errorList = std::move(parser.errors);
+    return program;
+}
+
+const std::vector<std::string> &ParserSession::errors() const {
+    return errorList;
+}
+
+std::size_t ParserSession::bytesReserved() const {
+    return arena->bytesReserved() + text->capacity();
+}
+
+std::size_t ParserSession::recycled() const {
+    return recycledCount;
+}
+
+bool ParserSession::recycle() {
+    // a Program from an earlier parse() still points into them
+    if (arena.use_count() > 1 || symbols.use_count() > 1 || text.use_count() > 1) {
+        arena = std::make_shared<ParseArena>();
+        symbols = std::make_shared<SymbolTable>();
+        text = std::make_shared<std::string>();
+        return false;
+    }
+    arena->reset(retainBytes);
+    symbols->clear(retainBytes);
+    if (text->capacity() > retainBytes) {
+        text->clear();
+        text->shrink_to_fit();
+    }
+    return true;
+}
@@ -0,0 +1,51 @@
+#ifndef PITAYA_PARSER_SESSION_H
+#define PITAYA_PARSER_SESSION_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser.h"
+
+// the most memory a ParserSession keeps from one parse for the next, in each of its arena, symbol storage and
+// source buffer
+static constexpr std::size_t PARSER_SESSION_RETAINED_BYTES = 4 * 1024 * 1024;
+
+// Parses one input after another on the same storage, so a long-running worker's memory levels off at what its
+// largest inputs need instead of growing with every request. The source is copied into a reused buffer, and the
+// Program is built in a reused arena and SymbolTable, with the parser's errors going into a reused vector. Storage is
+// recycled only once no Program holds on to it any more: a Program kept past the next parse() stays valid, and the
+// session then allocates fresh storage instead.
+//
+// Not thread-safe; give every worker thread its own session.
+struct ParserSession {
+    explicit ParserSession(ParserOptions options = {}, std::size_t retainBytes = PARSER_SESSION_RETAINED_BYTES);
+
+    std::shared_ptr<const Program> parse(std::string_view source);
+
+    // errors of the last parse()
+    [[nodiscard]] const std::vector<std::string> &errors() const;
+
+    // memory the arena and source buffer keep between parses
+    [[nodiscard]] std::size_t bytesReserved() const;
+
+    // how many parses ran on recycled storage
+    [[nodiscard]] std::size_t recycled() const;
+
+private:
+    const ParserOptions options;
+    const std::size_t retainBytes;
+    std::shared_ptr<std::string> text = std::make_shared<std::string>();
+    std::shared_ptr<ParseArena> arena = std::make_shared<ParseArena>();
+    std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>();
+    std::vector<std::string> errorList;
+    std::size_t recycledCount = 0;
+    bool used = false;
+
+    // makes every piece of storage ready for another parse, reusing the ones nothing else holds
+    bool recycle();
+};
+
+#endif //PITAYA_PARSER_SESSION_H
@@ -0,0 +1,59 @@
+#include "pipelined_lexer.h"
+
+#include <utility>
+
+namespace PipelinedLexerUtil {
+    // Busy-waits a little before giving the core away: the other side usually frees up a slot within a few
+    // hundred cycles, but on a machine with fewer cores than threads only yielding lets it run at all.
+    struct Backoff {
+        static constexpr int SPINS = 64;
+        int attempts = 0;
+
+        void pause() {
+            if (++attempts > SPINS) {
+                std::this_thread::yield();
+            }
+        }
+    };
+}
+
+PipelinedLexer::PipelinedLexer(Lexer lexer, const std::size_t capacity) : owner{lexer.source()},
+                                                                           ring{capacity, Token{TokenType::ILLEGAL, ""}} {
+    producer = std::jthread{
+        [this, lexer = std::move(lexer)](const std::stop_token &stop) mutable { produce(stop, std::move(lexer)); }
+    };
+}
+
+Token PipelinedLexer::nextToken() {
+    if (finished) {
+        return Token{TokenType::EOF_, ""};
+    }
+    PipelinedLexerUtil::Backoff backoff;
+    while (true) {
+        if (const auto token = ring.tryPop(); token.has_value()) {
+            finished = token->tokenType == TokenType::EOF_;
+            return token.value();
+        }
+        backoff.pause();
+    }
+}
+
+std::shared_ptr<const void> PipelinedLexer::source() const {
+    return owner;
+}
+
+void PipelinedLexer::produce(const std::stop_token &stop, Lexer lexer) {
+    while (true) {
+        const auto token = lexer.nextToken();
+        PipelinedLexerUtil::Backoff backoff;
+        while (!ring.tryPush(token)) {
+            if (stop.stop_requested()) {
+                return;
+            }
+            backoff.pause();
+        }
+        if (token.tokenType == TokenType::EOF_) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef PITAYA_PIPELINED_LEXER_H
+#define PITAYA_PIPELINED_LEXER_H
+
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+#include "lexer.h"
+#include "spsc_ring.h"
+
+static constexpr std::size_t DEFAULT_PIPELINE_CAPACITY = 4096;
+
+// Runs a Lexer on its own thread, feeding tokens through an SpscRing to whoever calls nextToken(), so lexing
+// overlaps with parsing. Either side spins and then yields while the ring is empty or full. Destroying the
+// PipelinedLexer before EOF_ stops the lexer thread.
+struct PipelinedLexer final : TokenSource {
+    explicit PipelinedLexer(Lexer lexer, std::size_t capacity = DEFAULT_PIPELINE_CAPACITY);
+
+    PipelinedLexer(const PipelinedLexer &) = delete;
+
+    PipelinedLexer &operator=(const PipelinedLexer &) = delete;
+
+    // after EOF_, keeps returning EOF_
+    Token nextToken() override;
+
+    [[nodiscard]] std::shared_ptr<const void> source() const override;
+
+private:
+    const std::shared_ptr<const void> owner;
+    SpscRing<Token> ring;
+    bool finished = false;
+    // declared last: the thread uses everything above, so it must be stopped and joined first
+    std::jthread producer;
+
+    void produce(const std::stop_token &stop, Lexer lexer);
+};
+
+#endif //PITAYA_PIPELINED_LEXER_H
@@ -0,0 +1,266 @@
+#include "scanner.h"
+
+#include <bit>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PITAYA_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ScannerScalar {
+    template<std::uint8_t Class>
+    std::size_t skipClass(const std::string_view input, std::size_t from) {
+        while (from < input.size() && Scanner::charClass(input[from]) & Class) {
+            from++;
+        }
+        return from;
+    }
+
+    std::size_t skipWhitespace(const std::string_view input, const std::size_t from) {
+        return skipClass<Scanner::WHITESPACE>(input, from);
+    }
+
+    std::size_t skipIdentifier(const std::string_view input, const std::size_t from) {
+        return skipClass<Scanner::LETTER>(input, from);
+    }
+
+    std::size_t skipDigits(const std::string_view input, const std::size_t from) {
+        return skipClass<Scanner::DIGIT>(input, from);
+    }
+
+    std::size_t findStringEnd(const std::string_view input, std::size_t from) {
+        while (from < input.size() && input[from] != '"' && input[from] != ZERO) {
+            from++;
+        }
+        return from;
+    }
+
+    std::size_t findBlockSyntax(const std::string_view input, std::size_t from) {
+        while (from < input.size() && input[from] != '{' && input[from] != '}' && input[from] != '"' &&
+               input[from] != ZERO) {
+            from++;
+        }
+        return from;
+    }
+}
+
+#ifdef PITAYA_SCANNER_X86
+// Each kernel builds a per-byte mask of the characters that belong to the run, then uses the first cleared bit of
+// the movemask to find where the run ends. Ranges are tested with the signed-compare trick: adding (128 - lo)
+// moves [lo, lo + n) to [-128, -128 + n), which a single signed less-than can check.
+namespace ScannerSSE2 {
+    __attribute__((target("sse2"))) inline __m128i inRange(const __m128i chunk, const char lo, const char count) {
+        const auto shifted = _mm_add_epi8(chunk, _mm_set1_epi8(static_cast<char>(128 - lo)));
+        return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + count)));
+    }
+
+    __attribute__((target("sse2"))) inline __m128i whitespaces(const __m128i chunk) {
+        return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+                            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')),
+                                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))));
+    }
+
+    __attribute__((target("sse2"))) inline __m128i letters(const __m128i chunk) {
+        const auto lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+        return _mm_or_si128(inRange(lower, 'a', 26), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_')));
+    }
+
+    __attribute__((target("sse2"))) inline __m128i digits(const __m128i chunk) {
+        return inRange(chunk, '0', 10);
+    }
+
+    __attribute__((target("sse2"))) inline __m128i stringEnds(const __m128i chunk) {
+        return _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8(ZERO)));
+    }
+
+    __attribute__((target("sse2"))) inline __m128i blockSyntax(const __m128i chunk) {
+        return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('{')),
+                                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('}'))), stringEnds(chunk));
+    }
+
+    // Skips bytes while matcher accepts them (Skip = true) or until matcher accepts one (Skip = false)
+    template<__m128i (*Matcher)(__m128i), bool Skip>
+    __attribute__((target("sse2"))) std::size_t scan(const std::string_view input, std::size_t from,
+                                                     std::size_t (*tail)(std::string_view, std::size_t)) {
+        const auto data = input.data();
+        while (from + 16 <= input.size()) {
+            const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + from));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(Matcher(chunk)));
+            if (Skip) {
+                mask = ~mask & 0xFFFFu;
+            }
+            if (mask != 0) {
+                return from + std::countr_zero(mask);
+            }
+            from += 16;
+        }
+        return tail(input, from);
+    }
+
+    __attribute__((target("sse2"))) std::size_t skipWhitespace(const std::string_view input, const std::size_t from) {
+        return scan<whitespaces, true>(input, from, ScannerScalar::skipWhitespace);
+    }
+
+    __attribute__((target("sse2"))) std::size_t skipIdentifier(const std::string_view input, const std::size_t from) {
+        return scan<letters, true>(input, from, ScannerScalar::skipIdentifier);
+    }
+
+    __attribute__((target("sse2"))) std::size_t skipDigits(const std::string_view input, const std::size_t from) {
+        return scan<digits, true>(input, from, ScannerScalar::skipDigits);
+    }
+
+    __attribute__((target("sse2"))) std::size_t findStringEnd(const std::string_view input, const std::size_t from) {
+        return scan<stringEnds, false>(input, from, ScannerScalar::findStringEnd);
+    }
+
+    __attribute__((target("sse2"))) std::size_t findBlockSyntax(const std::string_view input, const std::size_t from) {
+        return scan<blockSyntax, false>(input, from, ScannerScalar::findBlockSyntax);
+    }
+}
+
+namespace ScannerAVX2 {
+    __attribute__((target("avx2"))) inline __m256i inRange(const __m256i chunk, const char lo, const char count) {
+        const auto shifted = _mm256_add_epi8(chunk, _mm256_set1_epi8(static_cast<char>(128 - lo)));
+        return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + count)), shifted);
+    }
+
+    __attribute__((target("avx2"))) inline __m256i whitespaces(const __m256i chunk) {
+        return _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                                               _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+                               _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')),
+                                               _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'))));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i letters(const __m256i chunk) {
+        const auto lower = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+        return _mm256_or_si256(inRange(lower, 'a', 26), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('_')));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i digits(const __m256i chunk) {
+        return inRange(chunk, '0', 10);
+    }
+
+    __attribute__((target("avx2"))) inline __m256i stringEnds(const __m256i chunk) {
+        return _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')),
+                               _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(ZERO)));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i blockSyntax(const __m256i chunk) {
+        return _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('{')),
+                                               _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('}'))), stringEnds(chunk));
+    }
+
+    template<__m256i (*Matcher)(__m256i), bool Skip>
+    __attribute__((target("avx2"))) std::size_t scan(const std::string_view input, std::size_t from,
+                                                     std::size_t (*tail)(std::string_view, std::size_t)) {
+        const auto data = input.data();
+        while (from + 32 <= input.size()) {
+            const auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + from));
+            auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(Matcher(chunk)));
+            if (Skip) {
+                mask = ~mask;
+            }
+            if (mask != 0) {
+                return from + std::countr_zero(mask);
+            }
+            from += 32;
+        }
+        return tail(input, from);
+    }
+
+    __attribute__((target("avx2"))) std::size_t skipWhitespace(const std::string_view input, const std::size_t from) {
+        return scan<whitespaces, true>(input, from, ScannerSSE2::skipWhitespace);
+    }
+
+    __attribute__((target("avx2"))) std::size_t skipIdentifier(const std::string_view input, const std::size_t from) {
+        return scan<letters, true>(input, from, ScannerSSE2::skipIdentifier);
+    }
+
+    __attribute__((target("avx2"))) std::size_t skipDigits(const std::string_view input, const std::size_t from) {
+        return scan<digits, true>(input, from, ScannerSSE2::skipDigits);
+    }
+
+    __attribute__((target("avx2"))) std::size_t findStringEnd(const std::string_view input, const std::size_t from) {
+        return scan<stringEnds, false>(input, from, ScannerSSE2::findStringEnd);
+    }
+
+    __attribute__((target("avx2"))) std::size_t findBlockSyntax(const std::string_view input, const std::size_t from) {
+        return scan<blockSyntax, false>(input, from, ScannerSSE2::findBlockSyntax);
+    }
+}
+#endif
+
+namespace Scanner {
+    constexpr ScanKernels SCALAR_KERNELS{
+        ScanLevel::SCALAR,
+        ScannerScalar::skipWhitespace,
+        ScannerScalar::skipIdentifier,
+        ScannerScalar::skipDigits,
+        ScannerScalar::findStringEnd,
+        ScannerScalar::findBlockSyntax,
+    };
+
+#ifdef PITAYA_SCANNER_X86
+    constexpr ScanKernels SSE2_KERNELS{
+        ScanLevel::SSE2,
+        ScannerSSE2::skipWhitespace,
+        ScannerSSE2::skipIdentifier,
+        ScannerSSE2::skipDigits,
+        ScannerSSE2::findStringEnd,
+        ScannerSSE2::findBlockSyntax,
+    };
+
+    constexpr ScanKernels AVX2_KERNELS{
+        ScanLevel::AVX2,
+        ScannerAVX2::skipWhitespace,
+        ScannerAVX2::skipIdentifier,
+        ScannerAVX2::skipDigits,
+        ScannerAVX2::findStringEnd,
+        ScannerAVX2::findBlockSyntax,
+    };
+#endif
+
+    const char *to_string(const ScanLevel level) {
+        switch (level) {
+            case ScanLevel::SCALAR: return "scalar";
+            case ScanLevel::SSE2: return "SSE2";
+            case ScanLevel::AVX2: return "AVX2";
+            default: return "unknown";
+        }
+    }
+
+    bool supported(const ScanLevel level) {
+        switch (level) {
+            case ScanLevel::SCALAR:
+                return true;
+#ifdef PITAYA_SCANNER_X86
+            case ScanLevel::SSE2:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("sse2");
+            case ScanLevel::AVX2:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2");
+#endif
+            default:
+                return false;
+        }
+    }
+
+    const ScanKernels &kernels(const ScanLevel level) {
+#ifdef PITAYA_SCANNER_X86
+        if (level == ScanLevel::AVX2 && supported(ScanLevel::AVX2)) {
+            return AVX2_KERNELS;
+        }
+        if (level != ScanLevel::SCALAR && supported(ScanLevel::SSE2)) {
+            return SSE2_KERNELS;
+        }
+#endif
+        return SCALAR_KERNELS;
+    }
+
+    const ScanKernels &kernels() {
+        static const ScanKernels &best = kernels(ScanLevel::AVX2);
+        return best;
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef PITAYA_SCANNER_H
+#define PITAYA_SCANNER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "lexer.h"
+
+// Run-length scanning used by the Lexer to skip whole runs of whitespace, identifier characters, digits or
+// string-literal bodies at once, or to jump between the braces and quotes of a block. On x86 the runs are classified
+// 16 (SSE2) or 32 (AVX2) bytes at a time; the widest level supported by the CPU is picked at runtime, with a scalar
+// fallback everywhere else.
+namespace Scanner {
+    enum CharClass : std::uint8_t {
+        OTHER = 0,
+        WHITESPACE = 1 << 0,
+        LETTER = 1 << 1,
+        DIGIT = 1 << 2,
+        // single-character tokens that never start a longer one, so a token always ends right after them
+        DELIMITER = 1 << 3,
+    };
+
+    constexpr std::array<std::uint8_t, 256> CHAR_CLASSES = [] {
+        std::array<std::uint8_t, 256> classes{};
+        for (const auto whitespace: WHITESPACES) {
+            classes[static_cast<unsigned char>(whitespace)] |= WHITESPACE;
+        }
+        for (auto c = 'a'; c <= 'z'; c++) {
+            classes[static_cast<unsigned char>(c)] |= LETTER;
+        }
+        for (auto c = 'A'; c <= 'Z'; c++) {
+            classes[static_cast<unsigned char>(c)] |= LETTER;
+        }
+        classes['_'] |= LETTER;
+        for (auto c = '0'; c <= '9'; c++) {
+            classes[static_cast<unsigned char>(c)] |= DIGIT;
+        }
+        for (const auto delimiter: std::string_view{";,()[]{}:"}) {
+            classes[static_cast<unsigned char>(delimiter)] |= DELIMITER;
+        }
+        return classes;
+    }();
+
+    inline std::uint8_t charClass(const char c) {
+        return CHAR_CLASSES[static_cast<unsigned char>(c)];
+    }
+
+    enum struct ScanLevel {
+        SCALAR,
+        SSE2,
+        AVX2,
+    };
+
+    const char *to_string(ScanLevel level);
+
+    // Every kernel returns the index of the first byte at or after `from` that ends the run, or input.size()
+    struct ScanKernels {
+        ScanLevel level;
+        std::size_t (*skipWhitespace)(std::string_view input, std::size_t from);
+        std::size_t (*skipIdentifier)(std::string_view input, std::size_t from);
+        std::size_t (*skipDigits)(std::string_view input, std::size_t from);
+        // finds the closing '"' of a string literal, stopping early at an embedded ZERO
+        std::size_t (*findStringEnd)(std::string_view input, std::size_t from);
+        // finds the next byte that matters when matching braces: '{', '}', '"' or ZERO
+        std::size_t (*findBlockSyntax)(std::string_view input, std::size_t from);
+    };
+
+    [[nodiscard]] bool supported(ScanLevel level);
+
+    [[nodiscard]] const ScanKernels &kernels(ScanLevel level);
+
+    // the widest kernels the running CPU supports, detected once
+    [[nodiscard]] const ScanKernels &kernels();
+}
+
+#endif //PITAYA_SCANNER_H
@@ -0,0 +1,71 @@
+#ifndef PITAYA_SPSC_RING_H
+#define PITAYA_SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread. Each side owns one index and
+// keeps a cached copy of the other's, so the shared cache lines are only touched when the cache says the ring
+// looks full (producer) or empty (consumer).
+template<typename T>
+struct SpscRing {
+    // capacity is rounded up to a power of two; empty slots hold a copy of filler
+    explicit SpscRing(const std::size_t capacity, const T &filler = T{}) : slots(slotCount(capacity), filler),
+                                                                           mask{slots.size() - 1} {
+    }
+
+    // producer only; false when the ring is full
+    bool tryPush(const T &value) {
+        const auto tail = producer.index.load(std::memory_order_relaxed);
+        if (tail - producer.cachedOther == slots.size()) {
+            producer.cachedOther = consumer.index.load(std::memory_order_acquire);
+            if (tail - producer.cachedOther == slots.size()) {
+                return false;
+            }
+        }
+        slots[tail & mask] = value;
+        producer.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only; nullopt when the ring is empty
+    std::optional<T> tryPop() {
+        const auto head = consumer.index.load(std::memory_order_relaxed);
+        if (head == consumer.cachedOther) {
+            consumer.cachedOther = producer.index.load(std::memory_order_acquire);
+            if (head == consumer.cachedOther) {
+                return std::nullopt;
+            }
+        }
+        auto value = slots[head & mask];
+        consumer.index.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    [[nodiscard]] std::size_t capacity() const {
+        return slots.size();
+    }
+
+private:
+    static std::size_t slotCount(const std::size_t capacity) {
+        return std::bit_ceil(std::max<std::size_t>(capacity, 2));
+    }
+
+    // the two sides on separate cache lines so they don't invalidate each other on every operation
+    struct alignas(64) Side {
+        std::atomic<std::size_t> index = 0;
+        std::size_t cachedOther = 0;
+    };
+
+    std::vector<T> slots;
+    const std::size_t mask;
+    Side producer;
+    Side consumer;
+};
+
+#endif //PITAYA_SPSC_RING_H
@@ -0,0 +1,111 @@
+#include "stream_lexer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <unistd.h>
+
+#include "scanner.h"
+
+StreamLexer::StreamLexer(std::istream &in, const std::size_t chunkSize) : in{&in}, chunkSize{std::max<std::size_t>(
+        chunkSize, 1)}, literals{std::make_shared<ParseArena>()} {
+}
+
+StreamLexer::StreamLexer(const int fd, const std::size_t chunkSize) : fd{fd}, chunkSize{std::max<std::size_t>(
+        chunkSize, 1)}, literals{std::make_shared<ParseArena>()} {
+}
+
+Token StreamLexer::nextToken() {
+    while (true) {
+        if (lexer.has_value()) {
+            if (const auto token = lexer->nextToken(); token.tokenType != TokenType::EOF_) {
+                return persist(token);
+            }
+            lexer.reset();
+        }
+        if (!refill()) {
+            return Token{TokenType::EOF_, ""};
+        }
+    }
+}
+
+std::shared_ptr<const void> StreamLexer::source() const {
+    return literals;
+}
+
+std::size_t StreamLexer::peakBuffered() const {
+    return peak;
+}
+
+std::size_t StreamLexer::read(char *into, const std::size_t size) {
+    if (in != nullptr) {
+        in->read(into, static_cast<std::streamsize>(size));
+        return static_cast<std::size_t>(in->gcount());
+    }
+    while (true) {
+        const auto count = ::read(fd, into, size);
+        if (count >= 0) {
+            return static_cast<std::size_t>(count);
+        }
+        if (errno != EINTR) {
+            throw std::system_error{errno, std::generic_category(), "read"};
+        }
+    }
+}
+
+void StreamLexer::scan() {
+    for (; scanned < window.size(); scanned++) {
+        const auto c = window[scanned];
+        if (inString) {
+            // the Lexer ends a string literal at its closing quote or at an embedded ZERO
+            inString = c != '"' && c != ZERO;
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == ZERO) {
+            // the Lexer stops at a ZERO outside a string literal, and so does the stream
+            window.resize(scanned);
+            exhausted = true;
+            return;
+        } else if (Scanner::charClass(c) & (Scanner::WHITESPACE | Scanner::DELIMITER)) {
+            cut = scanned + 1;
+        }
+    }
+}
+
+bool StreamLexer::refill() {
+    while (cut == 0 && !exhausted) {
+        const auto size = window.size();
+        window.resize(size + chunkSize);
+        const auto count = read(window.data() + size, chunkSize);
+        window.resize(size + count);
+        peak = std::max(peak, segment.size() + window.size());
+        if (count == 0) {
+            exhausted = true;
+        }
+        scan();
+    }
+    // once nothing more comes, whatever is left is the last segment
+    const auto end = cut == 0 ? window.size() : cut;
+    if (end == 0) {
+        return false;
+    }
+    segment.assign(window, 0, end);
+    window.erase(0, end);
+    scanned -= std::min(scanned, end);
+    cut = 0;
+    lexer.emplace(std::string_view{segment});
+    return true;
+}
+
+Token StreamLexer::persist(Token token) {
+    if (const auto fixed = fixedLiteral(token.tokenType); !fixed.empty()) {
+        token.literal = fixed;
+        return token;
+    }
+    const auto memory = static_cast<char *>(literals->allocate(token.literal.size(), alignof(char)));
+    std::ranges::copy(token.literal, memory);
+    token.literal = std::string_view{memory, token.literal.size()};
+    return token;
+}
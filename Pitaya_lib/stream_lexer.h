@@ -0,0 +1,68 @@
+#ifndef PITAYA_STREAM_LEXER_H
+#define PITAYA_STREAM_LEXER_H
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "arena.h"
+#include "lexer.h"
+
+static constexpr std::size_t DEFAULT_STREAM_CHUNK_SIZE = 64 * 1024;
+
+// Lexes input pulled in fixed-size chunks from an std::istream or a file descriptor, for scripts arriving on stdin,
+// pipes or sockets. Only the text since the last token boundary is buffered: the window is cut after the last
+// whitespace or delimiter (`;`, `,`, brackets, `:`) outside a string literal, every complete segment is lexed by a
+// plain Lexer, and the rest waits for the next chunk, so tokens and string literals straddling chunks come out whole.
+// Memory stays bounded by the chunk size plus the longest run without either, even for minified input.
+//
+// The variable part of each token (identifiers, numbers, strings) is copied into an arena that source() hands on to
+// the Program; operators and keywords point to static text.
+struct StreamLexer final : TokenSource {
+    explicit StreamLexer(std::istream &in, std::size_t chunkSize = DEFAULT_STREAM_CHUNK_SIZE);
+
+    // reads fd until end of file; the descriptor stays owned by the caller
+    explicit StreamLexer(int fd, std::size_t chunkSize = DEFAULT_STREAM_CHUNK_SIZE);
+
+    Token nextToken() override;
+
+    [[nodiscard]] std::shared_ptr<const void> source() const override;
+
+    // the most input held at once so far, read but not yet lexed plus the segment being lexed
+    [[nodiscard]] std::size_t peakBuffered() const;
+
+private:
+    std::istream *in = nullptr;
+    int fd = -1;
+    const std::size_t chunkSize;
+    std::shared_ptr<ParseArena> literals;
+
+    // read but not yet lexed; starts at a token boundary outside any string literal
+    std::string window;
+    // how much of window has been classified, and whether that position is inside a string literal
+    std::size_t scanned = 0;
+    bool inString = false;
+    // end of the last whitespace or delimiter outside a string literal in window[0, scanned)
+    std::size_t cut = 0;
+    // no more input: the stream is exhausted or a ZERO was found outside a string literal
+    bool exhausted = false;
+
+    // the segment being lexed, kept until every token of it is copied out
+    std::string segment;
+    std::optional<Lexer> lexer;
+    std::size_t peak = 0;
+
+    std::size_t read(char *into, std::size_t size);
+
+    // classifies window[scanned, size()), moving cut forward
+    void scan();
+
+    // moves the next complete segment out of window into a fresh lexer; false once the input is used up
+    bool refill();
+
+    Token persist(Token token);
+};
+
+#endif //PITAYA_STREAM_LEXER_H
@@ -0,0 +1,48 @@
+#include "symbols.h"
+
+#include <algorithm>
+
+SymbolTable::SymbolTable(const std::size_t chunkSize) : storage{chunkSize} {
+}
+
+Symbol SymbolTable::intern(const std::string_view text) {
+    if (const auto found = ids.find(text); found != ids.end()) {
+        return Symbol{found->second, names[found->second]};
+    }
+    const auto memory = static_cast<char *>(storage.allocate(text.size(), alignof(char)));
+    std::ranges::copy(text, memory);
+    const auto name = std::string_view{memory, text.size()};
+    const auto id = static_cast<SymbolId>(names.size());
+    names.push_back(name);
+    ids.emplace(name, id);
+    return Symbol{id, name};
+}
+
+void SymbolTable::clear(const std::size_t retainBytes) {
+    names.clear();
+    ids.clear();
+    storage.reset(retainBytes);
+}
+
+std::optional<SymbolId> SymbolTable::find(const std::string_view text) const {
+    if (const auto found = ids.find(text); found != ids.end()) {
+        return found->second;
+    }
+    return std::nullopt;
+}
+
+std::string_view SymbolTable::name(const SymbolId id) const {
+    return names[id];
+}
+
+std::size_t SymbolTable::size() const {
+    return names.size();
+}
+
+std::size_t SymbolTable::bytes() const {
+    return storage.bytesAllocated();
+}
+
+std::size_t SymbolTable::bytesReserved() const {
+    return storage.bytesReserved();
+}
@@ -0,0 +1,52 @@
+#ifndef PITAYA_SYMBOLS_H
+#define PITAYA_SYMBOLS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "arena.h"
+
+using SymbolId = std::uint32_t;
+
+static constexpr std::size_t DEFAULT_SYMBOL_CHUNK_SIZE = 4 * 1024;
+
+struct Symbol {
+    SymbolId id;
+    // points into the SymbolTable's own storage, so every occurrence of a name shares one copy
+    std::string_view name;
+};
+
+// Interns identifier names and string literal contents for a single Program. Each distinct text is copied once and
+// gets a dense 32-bit id, so two symbols of the same table are equal exactly when their ids are.
+struct SymbolTable {
+    explicit SymbolTable(std::size_t chunkSize = DEFAULT_SYMBOL_CHUNK_SIZE);
+
+    Symbol intern(std::string_view text);
+
+    // forgets every symbol, keeping up to retainBytes of storage for the ones interned next
+    void clear(std::size_t retainBytes = std::numeric_limits<std::size_t>::max());
+
+    [[nodiscard]] std::optional<SymbolId> find(std::string_view text) const;
+
+    [[nodiscard]] std::string_view name(SymbolId id) const;
+
+    [[nodiscard]] std::size_t size() const;
+
+    // bytes used by the interned texts
+    [[nodiscard]] std::size_t bytes() const;
+
+    // bytes held for interned texts, including the unused rest of each storage chunk
+    [[nodiscard]] std::size_t bytesReserved() const;
+
+private:
+    ParseArena storage;
+    std::vector<std::string_view> names;
+    std::unordered_map<std::string_view, SymbolId> ids;
+};
+
+#endif //PITAYA_SYMBOLS_H
@@ -0,0 +1,245 @@
+#include "token_buffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "scanner.h"
+
+namespace TokenBufferUtil {
+    // a token per few bytes of mixed Monkey code, so most inputs lex without growing the arrays
+    constexpr std::size_t BYTES_PER_TOKEN = 4;
+
+    // Where the quote-parity scan of a slice ends up, for a slice that starts outside or inside a string literal
+    enum struct Parity : std::uint8_t {
+        OUTSIDE,
+        INSIDE,
+        // a ZERO outside a string literal: the Lexer stops there, and so does the input
+        STOPPED,
+    };
+
+    struct SliceParity {
+        Parity end = Parity::OUTSIDE;
+        std::size_t stop = 0;
+    };
+
+    // The same rules as the Lexer: a string literal ends at its closing quote or at a ZERO. Only quotes and ZEROs
+    // change the parity, which is exactly what findStringEnd skips to.
+    SliceParity scanParity(const std::string_view slice, const std::size_t base, Parity parity) {
+        const auto findStringEnd = Scanner::kernels().findStringEnd;
+        for (auto i = findStringEnd(slice, 0); i < slice.size(); i = findStringEnd(slice, i + 1)) {
+            if (parity == Parity::INSIDE) {
+                parity = Parity::OUTSIDE;
+            } else if (slice[i] == '"') {
+                parity = Parity::INSIDE;
+            } else {
+                return SliceParity{Parity::STOPPED, base + i};
+            }
+        }
+        return SliceParity{parity};
+    }
+
+    // first position at or after from, entered with the given parity, that follows whitespace or a delimiter outside
+    // a string literal; text.size() if there is none
+    std::size_t findBoundary(const std::string_view text, std::size_t from, Parity parity) {
+        for (; from < text.size(); from++) {
+            const auto c = text[from];
+            if (parity == Parity::INSIDE) {
+                if (c == '"' || c == ZERO) {
+                    parity = Parity::OUTSIDE;
+                }
+            } else if (c == '"') {
+                parity = Parity::INSIDE;
+            } else if (Scanner::charClass(c) & (Scanner::WHITESPACE | Scanner::DELIMITER)) {
+                return from + 1;
+            }
+        }
+        return text.size();
+    }
+
+    // runs fn(0) ... fn(count - 1) on count threads, fn(0) on the calling one
+    template<typename Fn>
+    void parallelFor(const std::size_t count, Fn fn) {
+        std::vector<std::jthread> threads;
+        threads.reserve(count - 1);
+        for (std::size_t i = 1; i < count; i++) {
+            threads.emplace_back([&fn, i] { fn(i); });
+        }
+        fn(0);
+    }
+
+    void checkLength(const std::string_view text) {
+        if (text.size() > MAX_TOKEN_BUFFER_INPUT) {
+            throw std::length_error{"input too long for a TokenBuffer"};
+        }
+    }
+}
+
+TokenBuffer TokenBuffer::lex(Lexer lexer) {
+    TokenBufferUtil::checkLength(lexer.text());
+    TokenBuffer buffer;
+    buffer.source = lexer.source();
+    buffer.text = lexer.text();
+    const auto expected = buffer.text.size() / TokenBufferUtil::BYTES_PER_TOKEN + 1;
+    buffer.reserve(expected);
+    auto token = lexer.nextToken();
+    while (token.tokenType != TokenType::EOF_) {
+        buffer.push(token);
+        token = lexer.nextToken();
+    }
+    buffer.push(token);
+    return buffer;
+}
+
+TokenBuffer TokenBuffer::lexParallel(const Lexer &lexer, std::size_t threads, const std::size_t minSegment) {
+    auto text = lexer.text();
+    TokenBufferUtil::checkLength(text);
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::clamp<std::size_t>(text.size() / std::max<std::size_t>(minSegment, 1), 1, threads);
+    if (threads == 1) {
+        return lex(Lexer{text, lexer.source()});
+    }
+    const auto cuts = segments(text, threads);
+    text = text.substr(0, cuts.back());
+
+    std::vector<TokenBuffer> parts(threads);
+    TokenBufferUtil::parallelFor(threads, [&](const std::size_t slice) {
+        auto &part = parts[slice];
+        part.text = text;
+        part.reserve((cuts[slice + 1] - cuts[slice]) / TokenBufferUtil::BYTES_PER_TOKEN);
+        Lexer segment{text.substr(cuts[slice], cuts[slice + 1] - cuts[slice])};
+        for (auto token = segment.nextToken(); token.tokenType != TokenType::EOF_; token = segment.nextToken()) {
+            part.push(token);
+        }
+    });
+
+    TokenBuffer buffer;
+    buffer.source = lexer.source();
+    buffer.text = text;
+    std::size_t size = 1;
+    for (const auto &part: parts) {
+        size += part.size();
+    }
+    buffer.reserve(size);
+    for (const auto &part: parts) {
+        buffer.append(part);
+    }
+    buffer.push(Token{TokenType::EOF_, ""});
+    return buffer;
+}
+
+std::vector<std::size_t> TokenBuffer::segments(std::string_view text, const std::size_t threads) {
+    using TokenBufferUtil::Parity;
+    // quote parity of every slice, for both ways it can start, then chained from the front
+    std::vector<TokenBufferUtil::SliceParity> fromOutside(threads);
+    std::vector<TokenBufferUtil::SliceParity> fromInside(threads);
+    std::vector<std::size_t> starts(threads + 1);
+    for (std::size_t slice = 0; slice <= threads; slice++) {
+        starts[slice] = slice * text.size() / threads;
+    }
+    TokenBufferUtil::parallelFor(threads, [&](const std::size_t slice) {
+        const auto part = text.substr(starts[slice], starts[slice + 1] - starts[slice]);
+        fromOutside[slice] = TokenBufferUtil::scanParity(part, starts[slice], Parity::OUTSIDE);
+        fromInside[slice] = TokenBufferUtil::scanParity(part, starts[slice], Parity::INSIDE);
+    });
+    std::vector<Parity> startParity(threads, Parity::OUTSIDE);
+    for (std::size_t slice = 0; slice + 1 < threads; slice++) {
+        const auto &end = startParity[slice] == Parity::INSIDE ? fromInside[slice] : fromOutside[slice];
+        if (end.end == Parity::STOPPED) {
+            text = text.substr(0, end.stop);
+            break;
+        }
+        startParity[slice + 1] = end.end;
+    }
+
+    // a slice starting past the end of the input gets an empty segment
+    std::vector<std::size_t> cuts(threads + 1, text.size());
+    cuts[0] = 0;
+    TokenBufferUtil::parallelFor(threads, [&](const std::size_t slice) {
+        if (slice > 0 && starts[slice] < text.size()) {
+            cuts[slice] = TokenBufferUtil::findBoundary(text, starts[slice], startParity[slice]);
+        }
+    });
+    for (std::size_t slice = 1; slice <= threads; slice++) {
+        cuts[slice] = std::max(cuts[slice], cuts[slice - 1]);
+    }
+    return cuts;
+}
+
+void TokenBuffer::append(const TokenBuffer &other) {
+    types.insert(types.end(), other.types.begin(), other.types.end());
+    offsets.insert(offsets.end(), other.offsets.begin(), other.offsets.end());
+    lengths.insert(lengths.end(), other.lengths.begin(), other.lengths.end());
+}
+
+void TokenBuffer::reserve(const std::size_t tokens) {
+    types.reserve(tokens);
+    offsets.reserve(tokens);
+    lengths.reserve(tokens);
+}
+
+void TokenBuffer::push(const Token token) {
+    types.push_back(token.tokenType);
+    // an empty literal (EOF_, "") may not point into text at all
+    offsets.push_back(static_cast<std::uint32_t>(token.literal.empty()
+                                                     ? text.size()
+                                                     : token.literal.data() - text.data()));
+    lengths.push_back(static_cast<std::uint32_t>(token.literal.size()));
+}
+
+std::size_t TokenBuffer::size() const {
+    return types.size();
+}
+
+Token TokenBuffer::token(const std::size_t index) const {
+    const auto i = std::min(index, size() - 1);
+    return types[i] == TokenType::INT ? Lexer::integer(literal(i)) : Token{types[i], literal(i)};
+}
+
+std::string_view TokenBuffer::literal(const std::size_t index) const {
+    return text.substr(offsets[index], lengths[index]);
+}
+
+TokenCursor::TokenCursor(TokenBuffer tokens) : tokens{std::move(tokens)} {
+}
+
+Token TokenCursor::nextToken() {
+    return tokens.token(index++);
+}
+
+std::shared_ptr<const void> TokenCursor::source() const {
+    return tokens.source;
+}
+
+std::optional<std::string_view> TokenCursor::skipBlock(const Token &open) {
+    auto start = index;
+    while (start > 0 && tokens.literal(start - 1).data() != open.literal.data()) {
+        start--;
+    }
+    if (start == 0 || open.tokenType != TokenType::LBRACE) {
+        return std::nullopt;
+    }
+    std::size_t depth = 1;
+    for (auto i = start; i < tokens.size(); i++) {
+        if (tokens.types[i] == TokenType::LBRACE) {
+            depth++;
+        } else if (tokens.types[i] == TokenType::RBRACE && --depth == 0) {
+            index = i;
+            const auto first = tokens.offsets[start - 1];
+            return tokens.text.substr(first, tokens.offsets[i] + 1 - first);
+        }
+    }
+    return std::nullopt;
+}
+
+Token TokenCursor::peek(const std::size_t ahead) const {
+    return tokens.token(index + ahead);
+}
+
+const TokenBuffer &TokenCursor::buffer() const {
+    return tokens;
+}
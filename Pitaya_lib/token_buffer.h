@@ -0,0 +1,82 @@
+#ifndef PITAYA_TOKEN_BUFFER_H
+#define PITAYA_TOKEN_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lexer.h"
+
+// lexParallel doesn't give a thread less input than this
+static constexpr std::size_t PARALLEL_LEX_MIN_SEGMENT = 256 * 1024;
+
+// the longest input a TokenBuffer can index with its 32-bit offsets
+static constexpr std::size_t MAX_TOKEN_BUFFER_INPUT = std::numeric_limits<std::uint32_t>::max();
+
+// Every token of an input, lexed in one pass and stored as parallel arrays so the lexer and the parser loops run
+// separately and the parser can look any distance ahead. Literals are kept as (offset, length) into text, which
+// limits an input to MAX_TOKEN_BUFFER_INPUT bytes. The last token is always EOF_.
+struct TokenBuffer {
+    // throws std::length_error for an input longer than MAX_TOKEN_BUFFER_INPUT, as does lexParallel()
+    static TokenBuffer lex(Lexer lexer);
+
+    // Same tokens as lex(), produced by up to `threads` threads (0 = one per hardware thread). The input is split
+    // by segments(), every segment is lexed on its own thread and the pieces are appended in order.
+    static TokenBuffer lexParallel(const Lexer &lexer, std::size_t threads = 0,
+                                   std::size_t minSegment = PARALLEL_LEX_MIN_SEGMENT);
+
+    // Where lexParallel splits text for `threads` (at least 1) threads: segment k is [cuts[k], cuts[k + 1]), and
+    // nothing past the last cut is lexed. A quote-parity pass finds where each equal slice starts relative to string
+    // literals, then every segment but the first starts right after the first whitespace or delimiter outside a string
+    // literal in its slice, so minified input splits as well as formatted input. Segments may be empty.
+    static std::vector<std::size_t> segments(std::string_view text, std::size_t threads);
+
+    // what keeps text alive, see TokenSource::source()
+    std::shared_ptr<const void> source;
+    std::string_view text;
+    std::vector<TokenType> types;
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> lengths;
+
+    // literal must point into text, or be empty
+    void push(Token token);
+
+    // appends every token of other, which must index the same text
+    void append(const TokenBuffer &other);
+
+    void reserve(std::size_t tokens);
+
+    [[nodiscard]] std::size_t size() const;
+
+    // indices past the end return the trailing EOF_. An INT's value is decoded again from its literal on every call
+    // rather than stored, which would add 8 bytes to every token for the few that are INTs.
+    [[nodiscard]] Token token(std::size_t index) const;
+
+    [[nodiscard]] std::string_view literal(std::size_t index) const;
+};
+
+// Walks a TokenBuffer from the front, one index per nextToken()
+struct TokenCursor final : TokenSource {
+    explicit TokenCursor(TokenBuffer tokens);
+
+    Token nextToken() override;
+
+    [[nodiscard]] std::shared_ptr<const void> source() const override;
+
+    // matches LBRACE and RBRACE tokens, string literals being single tokens already
+    std::optional<std::string_view> skipBlock(const Token &open) override;
+
+    // the token `ahead` positions after the one nextToken() returns next
+    [[nodiscard]] Token peek(std::size_t ahead) const;
+
+    [[nodiscard]] const TokenBuffer &buffer() const;
+
+private:
+    TokenBuffer tokens;
+    std::size_t index = 0;
+};
+
+#endif //PITAYA_TOKEN_BUFFER_H
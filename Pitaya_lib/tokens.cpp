@@ -1,22 +1,86 @@
-#include <string>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 #include <utility>
+
 #include "tokens.h"
 
+namespace TokensUtil {
+    constexpr std::array KEYWORDS = {
+        std::pair<std::string_view, TokenType>{"fn", TokenType::FUNCTION},
+        std::pair<std::string_view, TokenType>{"let", TokenType::LET},
+        std::pair<std::string_view, TokenType>{"true", TokenType::TRUE},
+        std::pair<std::string_view, TokenType>{"false", TokenType::FALSE},
+        std::pair<std::string_view, TokenType>{"if", TokenType::IF},
+        std::pair<std::string_view, TokenType>{"else", TokenType::ELSE},
+        std::pair<std::string_view, TokenType>{"return", TokenType::RETURN},
+    };
 
-TokenType lookupIdent(const std::string &literal) {
-    if (literal == "fn") return TokenType::FUNCTION;
-    if (literal == "let") return TokenType::LET;
-    if (literal == "true") return TokenType::TRUE;
-    if (literal == "false") return TokenType::FALSE;
-    if (literal == "if") return TokenType::IF;
-    if (literal == "else") return TokenType::ELSE;
-    if (literal == "return") return TokenType::RETURN;
-    return TokenType::IDENT;
-}
+    constexpr std::size_t KEYWORD_TABLE_SIZE = 8;
+    constexpr std::size_t MIN_KEYWORD_LENGTH = 2;
+    constexpr std::size_t MAX_KEYWORD_LENGTH = 6;
+
+    // (2 * length + first + last) mod 8 happens to be a minimal perfect hash over KEYWORDS
+    constexpr std::size_t keywordHash(const std::string_view literal) {
+        return (2 * literal.size() + static_cast<unsigned char>(literal.front()) +
+                static_cast<unsigned char>(literal.back())) % KEYWORD_TABLE_SIZE;
+    }
+
+    template<std::size_t Width>
+    constexpr std::uint32_t load(const char *p) {
+        if consteval {
+            std::uint32_t word = 0;
+            for (std::size_t i = 0; i < Width; i++) {
+                const auto shift = std::endian::native == std::endian::little ? 8 * i : 8 * (Width - 1 - i);
+                word |= static_cast<std::uint32_t>(static_cast<unsigned char>(p[i])) << shift;
+            }
+            return word;
+        } else {
+            std::conditional_t<Width == 2, std::uint16_t, std::uint32_t> word;
+            std::memcpy(&word, p, Width);
+            return word;
+        }
+    }
+
+    // Packs a 2..6 byte literal into one word with two overlapping fixed-width loads, so the final
+    // check is a single integer compare instead of a memcmp call
+    constexpr std::uint64_t pack(const std::string_view literal) {
+        const auto p = literal.data();
+        const auto n = literal.size();
+        if (n >= 4) {
+            return static_cast<std::uint64_t>(load<4>(p)) << 32 | load<4>(p + n - 4);
+        }
+        return static_cast<std::uint64_t>(load<2>(p)) << 16 | load<2>(p + n - 2);
+    }
 
+    struct Keyword {
+        std::uint64_t word = 0;
+        std::size_t length = 0;
+        TokenType tokenType = TokenType::IDENT;
+    };
 
-Token::Token(const TokenType tokenType, std::string literal) : tokenType{tokenType}, literal{std::move(literal)} {
+    constexpr auto KEYWORD_TABLE = [] {
+        std::array<Keyword, KEYWORD_TABLE_SIZE> table{};
+        for (const auto &[keyword, tokenType]: KEYWORDS) {
+            if (keyword.size() < MIN_KEYWORD_LENGTH || keyword.size() > MAX_KEYWORD_LENGTH) {
+                throw "keyword length outside [MIN_KEYWORD_LENGTH, MAX_KEYWORD_LENGTH]";
+            }
+            auto &slot = table[keywordHash(keyword)];
+            if (slot.length != 0) {
+                throw "keywordHash is not perfect over KEYWORDS";
+            }
+            slot = Keyword{pack(keyword), keyword.size(), tokenType};
+        }
+        return table;
+    }();
 }
 
-Token::Token(const TokenType tokenType, const char ch) : tokenType{tokenType}, literal{ch} {
+TokenType lookupIdent(const std::string_view literal) {
+    if (literal.size() < TokensUtil::MIN_KEYWORD_LENGTH || literal.size() > TokensUtil::MAX_KEYWORD_LENGTH) {
+        return TokenType::IDENT;
+    }
+    const auto &[word, length, tokenType] = TokensUtil::KEYWORD_TABLE[TokensUtil::keywordHash(literal)];
+    return length == literal.size() && TokensUtil::pack(literal) == word ? tokenType : TokenType::IDENT;
 }
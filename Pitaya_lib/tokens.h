@@ -1,8 +1,10 @@
 #ifndef PITAYA_TOKENS_H
 #define PITAYA_TOKENS_H
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
-enum struct TokenType {
+enum struct TokenType : std::uint8_t {
     ILLEGAL,
     EOF_,
     ASSIGN,
@@ -36,6 +38,8 @@ enum struct TokenType {
     STRING,
 };
 
+constexpr std::size_t TOKEN_TYPE_COUNT = static_cast<std::size_t>(TokenType::STRING) + 1;
+
 inline const char *to_string(const TokenType e) {
     switch (e) {
         case TokenType::ILLEGAL: return "ILLEGAL";
@@ -73,14 +77,58 @@ inline const char *to_string(const TokenType e) {
     }
 }
 
+// The text every token of the given type has, or "" for types whose literal varies (identifiers, numbers, strings,
+// illegal characters) and for EOF_
+constexpr std::string_view fixedLiteral(const TokenType e) {
+    switch (e) {
+        case TokenType::ASSIGN: return "=";
+        case TokenType::EQ: return "==";
+        case TokenType::NOT_EQ: return "!=";
+        case TokenType::PLUS: return "+";
+        case TokenType::COMMA: return ",";
+        case TokenType::SEMICOLON: return ";";
+        case TokenType::COLON: return ":";
+        case TokenType::MINUS: return "-";
+        case TokenType::BANG: return "!";
+        case TokenType::SLASH: return "/";
+        case TokenType::ASTERISK: return "*";
+        case TokenType::LT: return "<";
+        case TokenType::GT: return ">";
+        case TokenType::LPAREN: return "(";
+        case TokenType::RPAREN: return ")";
+        case TokenType::LBRACE: return "{";
+        case TokenType::RBRACE: return "}";
+        case TokenType::LBRACKET: return "[";
+        case TokenType::RBRACKET: return "]";
+        case TokenType::FUNCTION: return "fn";
+        case TokenType::LET: return "let";
+        case TokenType::TRUE: return "true";
+        case TokenType::FALSE: return "false";
+        case TokenType::IF: return "if";
+        case TokenType::ELSE: return "else";
+        case TokenType::RETURN: return "return";
+        default: return "";
+    }
+}
+
+// A token doesn't own its text: literal is a view into the source the Lexer was created with,
+// so lexing allocates nothing and tokens are cheap to pass around by value.
 struct Token {
     TokenType tokenType;
-    std::string literal;
+    // INT only: false when the literal doesn't fit in a long, value is then 0
+    bool inRange = true;
+    std::string_view literal;
+    // INT only: the literal decoded once by the Lexer
+    long value = 0;
 
-    Token(TokenType tokenType, std::string literal);
+    constexpr Token(const TokenType tokenType, const std::string_view literal) : tokenType{tokenType},
+        literal{literal} {
+    }
 
-    Token(TokenType tokenType, char ch);
+    constexpr Token(const TokenType tokenType, const std::string_view literal, const long value,
+                    const bool inRange) : tokenType{tokenType}, inRange{inRange}, literal{literal}, value{value} {
+    }
 };
 
-TokenType lookupIdent(const std::string &literal);
+TokenType lookupIdent(std::string_view literal);
 #endif //PITAYA_TOKENS_H